@@ -39,6 +39,10 @@
 #include "driverlib/lcd.h"
 #include "grlib/grlib.h"
 #include "drivers/kentec320x240x16_ssd2119.h"
+#ifdef SSD2119_BACK_BUFFER
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+#endif
 
 //*****************************************************************************
 //
@@ -111,6 +115,65 @@
 #define MAPPED_Y(x, y)          (y)
 #endif
 
+//*****************************************************************************
+//
+// The size of the screen in application coordinates.
+//
+//*****************************************************************************
+#if defined(PORTRAIT) || defined(PORTRAIT_FLIP)
+#define DISPLAY_WIDTH           240
+#define DISPLAY_HEIGHT          320
+#else
+#define DISPLAY_WIDTH           320
+#define DISPLAY_HEIGHT          240
+#endif
+
+//*****************************************************************************
+//
+// The driver can draw into an off-screen buffer in SRAM instead of straight to
+// the panel.  This is selected by defining SSD2119_BACK_BUFFER.  Drawing then
+// only marks the rectangles it touched as dirty, and the flush (GrFlush())
+// sends each dirty rectangle to the panel in a single burst.  Overlapping
+// repaints, such as a canvas fill followed by text on top of it, only cross
+// the bus once and are never seen half drawn.
+//
+// The buffer covers the whole screen by default, which takes 150KB of SRAM.
+// Defining BACK_BUFFER_X, BACK_BUFFER_Y, BACK_BUFFER_WIDTH and
+// BACK_BUFFER_HEIGHT buffers only that part of the screen, and drawing
+// outside of it goes straight to the panel as before.
+//
+// Tasks may draw into the buffer while another one flushes it: the dirty
+// rectangles are taken off the list with the scheduler disabled, and only one
+// task sends them at a time.  Drawing outside a partial buffer writes to the
+// panel directly, so like the unbuffered driver it must not race a flush.
+//
+//*****************************************************************************
+//#define SSD2119_BACK_BUFFER
+
+#ifdef SSD2119_BACK_BUFFER
+#ifndef BACK_BUFFER_X
+#define BACK_BUFFER_X           0
+#define BACK_BUFFER_Y           0
+#define BACK_BUFFER_WIDTH       DISPLAY_WIDTH
+#define BACK_BUFFER_HEIGHT      DISPLAY_HEIGHT
+#endif
+
+//
+// The number of dirty rectangles tracked between flushes.  When they run out,
+// the new rectangle is merged with the one that grows the least, unless that
+// would more than double what is sent, in which case the buffer is flushed
+// early instead.
+//
+#define BACK_BUFFER_DIRTY_RECTS 16
+
+//
+// Rectangles are merged when the union is at most this many pixels larger
+// than the two of them, which is about what setting up a window costs on the
+// bus.
+//
+#define BACK_BUFFER_MERGE_SLACK 16
+#endif
+
 //*****************************************************************************
 //
 // Various internal SD2119 registers name labels
@@ -308,6 +371,536 @@ WriteCommand(uint8_t ui8Data)
     LCDIDDCommandWrite(LCD0_BASE, 0, (uint16_t)ui8Data);
 }
 
+//*****************************************************************************
+//
+// Sets the panel's RAM window to a rectangle (in application coordinate
+// space), places the cursor at its upper left and starts a RAM write.  The
+// pixels that follow fill the rectangle a row at a time.
+//
+//*****************************************************************************
+static void
+PanelWindowSet(const tRectangle *psRect)
+{
+    //
+    // Write the Y extents of the rectangle.
+    //
+    WriteCommand(SSD2119_ENTRY_MODE_REG);
+    WriteData(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
+
+    //
+    // Write the X extents of the rectangle.
+    //
+    WriteCommand(SSD2119_H_RAM_START_REG);
+#if (defined PORTRAIT) || (defined LANDSCAPE)
+    WriteData(MAPPED_X(psRect->i16XMax, psRect->i16YMax));
+#else
+    WriteData(MAPPED_X(psRect->i16XMin, psRect->i16YMin));
+#endif
+
+    WriteCommand(SSD2119_H_RAM_END_REG);
+#if (defined PORTRAIT) || (defined LANDSCAPE)
+    WriteData(MAPPED_X(psRect->i16XMin, psRect->i16YMin));
+#else
+    WriteData(MAPPED_X(psRect->i16XMax, psRect->i16YMax));
+#endif
+
+    //
+    // Write the Y extents of the rectangle
+    //
+    WriteCommand(SSD2119_V_RAM_POS_REG);
+#if (defined LANDSCAPE_FLIP) || (defined PORTRAIT)
+    WriteData(MAPPED_Y(psRect->i16XMin, psRect->i16YMin) |
+             (MAPPED_Y(psRect->i16XMax, psRect->i16YMax) << 8));
+#else
+    WriteData(MAPPED_Y(psRect->i16XMax, psRect->i16YMax) |
+             (MAPPED_Y(psRect->i16XMin, psRect->i16YMin) << 8));
+#endif
+
+    //
+    // Set the display cursor to the upper left of the rectangle (in
+    // application coordinate space).
+    //
+    WriteCommand(SSD2119_X_RAM_ADDR_REG);
+    WriteData(MAPPED_X(psRect->i16XMin, psRect->i16YMin));
+    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
+    WriteData(MAPPED_Y(psRect->i16XMin, psRect->i16YMin));
+
+    //
+    // Tell the controller to write data into its RAM.
+    //
+    WriteCommand(SSD2119_RAM_DATA_REG);
+}
+
+//*****************************************************************************
+//
+// Sets the panel's RAM window back to the entire screen.
+//
+//*****************************************************************************
+static void
+PanelWindowReset(void)
+{
+    //
+    // Reset the X extents to the entire screen.
+    //
+    WriteCommand(SSD2119_H_RAM_START_REG);
+    WriteData(0x0000);
+    WriteCommand(SSD2119_H_RAM_END_REG);
+    WriteData(0x013f);
+
+    //
+    // Reset the Y extent to the full screen
+    //
+    WriteCommand(SSD2119_V_RAM_POS_REG);
+    WriteData(0xef00);
+}
+
+//*****************************************************************************
+//
+// Fills a rectangle on the panel with a single color.
+//
+//*****************************************************************************
+static void
+PanelRectFill(const tRectangle *psRect, uint32_t ui32Value)
+{
+    int32_t i32Count;
+
+    PanelWindowSet(psRect);
+
+    //
+    // Loop through the pixels of this filled rectangle.
+    //
+    for(i32Count = ((psRect->i16XMax - psRect->i16XMin + 1) *
+                    (psRect->i16YMax - psRect->i16YMin + 1)); i32Count >= 0;
+        i32Count--)
+    {
+        //
+        // Write the pixel value.
+        //
+        WriteData(ui32Value);
+    }
+
+    PanelWindowReset();
+}
+
+#ifdef SSD2119_BACK_BUFFER
+//*****************************************************************************
+//
+// The off-screen buffer, a row at a time in application coordinate space, and
+// the rectangles of it that differ from the panel.
+//
+//*****************************************************************************
+static uint16_t g_pui16BackBuffer[BACK_BUFFER_WIDTH * BACK_BUFFER_HEIGHT];
+static const tRectangle g_sBackBufferArea =
+{
+    BACK_BUFFER_X,
+    BACK_BUFFER_Y,
+    BACK_BUFFER_X + BACK_BUFFER_WIDTH - 1,
+    BACK_BUFFER_Y + BACK_BUFFER_HEIGHT - 1,
+};
+static tRectangle g_psDirtyRects[BACK_BUFFER_DIRTY_RECTS];
+static uint32_t g_ui32DirtyCount;
+
+//
+// Set while a task is sending dirty rectangles to the panel.
+//
+static volatile bool g_bSending;
+
+//*****************************************************************************
+//
+// A horizontal run of pixels decoded by PixelDrawMultiple(), before it is
+// copied into the buffer.
+//
+//*****************************************************************************
+static uint16_t g_pui16Run[DISPLAY_WIDTH];
+static uint32_t g_ui32RunLength;
+
+//*****************************************************************************
+//
+// Returns a pointer to a pixel of the buffer.
+//
+//*****************************************************************************
+#define BACK_BUFFER_PIXEL(x, y)                                               \
+                                (&g_pui16BackBuffer[((y) - BACK_BUFFER_Y) *   \
+                                                    BACK_BUFFER_WIDTH +       \
+                                                    (x) - BACK_BUFFER_X])
+
+//*****************************************************************************
+//
+// Finds the overlap of two rectangles.  Returns false if there is none.
+//
+//*****************************************************************************
+static bool
+RectIntersect(const tRectangle *psA, const tRectangle *psB,
+              tRectangle *psOverlap)
+{
+    psOverlap->i16XMin = (psA->i16XMin > psB->i16XMin) ? psA->i16XMin :
+                                                          psB->i16XMin;
+    psOverlap->i16YMin = (psA->i16YMin > psB->i16YMin) ? psA->i16YMin :
+                                                          psB->i16YMin;
+    psOverlap->i16XMax = (psA->i16XMax < psB->i16XMax) ? psA->i16XMax :
+                                                          psB->i16XMax;
+    psOverlap->i16YMax = (psA->i16YMax < psB->i16YMax) ? psA->i16YMax :
+                                                          psB->i16YMax;
+
+    return((psOverlap->i16XMin <= psOverlap->i16XMax) &&
+           (psOverlap->i16YMin <= psOverlap->i16YMax));
+}
+
+//*****************************************************************************
+//
+// Finds the smallest rectangle covering two rectangles.
+//
+//*****************************************************************************
+static void
+RectUnion(const tRectangle *psA, const tRectangle *psB, tRectangle *psUnion)
+{
+    psUnion->i16XMin = (psA->i16XMin < psB->i16XMin) ? psA->i16XMin :
+                                                        psB->i16XMin;
+    psUnion->i16YMin = (psA->i16YMin < psB->i16YMin) ? psA->i16YMin :
+                                                        psB->i16YMin;
+    psUnion->i16XMax = (psA->i16XMax > psB->i16XMax) ? psA->i16XMax :
+                                                        psB->i16XMax;
+    psUnion->i16YMax = (psA->i16YMax > psB->i16YMax) ? psA->i16YMax :
+                                                        psB->i16YMax;
+}
+
+static int32_t
+RectArea(const tRectangle *psRect)
+{
+    return((psRect->i16XMax - psRect->i16XMin + 1) *
+           (psRect->i16YMax - psRect->i16YMin + 1));
+}
+
+//*****************************************************************************
+//
+// Returns how many more pixels the union of two rectangles covers than the
+// two of them do.
+//
+//*****************************************************************************
+static int32_t
+RectMergeGrowth(const tRectangle *psA, const tRectangle *psB)
+{
+    tRectangle sUnion;
+
+    RectUnion(psA, psB, &sUnion);
+    return(RectArea(&sUnion) - RectArea(psA) - RectArea(psB));
+}
+
+//*****************************************************************************
+//
+// Moves the dirty rectangles into psRects, leaving the list empty, and marks
+// them as being sent.  Returns how many there were.
+//
+// Assumption: Called with the scheduler disabled and g_bSending clear.
+//
+//*****************************************************************************
+static uint32_t
+DirtyTake(tRectangle *psRects)
+{
+    uint32_t ui32Idx, ui32Count = g_ui32DirtyCount;
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        psRects[ui32Idx] = g_psDirtyRects[ui32Idx];
+    }
+    g_ui32DirtyCount = 0;
+    g_bSending = ui32Count != 0;
+
+    return(ui32Count);
+}
+
+//*****************************************************************************
+//
+// Sends rectangles of the buffer to the panel, each with one window setup and
+// a single burst of pixel writes, then lets the next sender in.  Pixels drawn
+// into them meanwhile are marked dirty again, so they go out next time.
+//
+//*****************************************************************************
+static void
+DirtySend(const tRectangle *psRects, uint32_t ui32Count)
+{
+    const uint16_t *pui16Row;
+    uint32_t ui32Idx;
+    int32_t i32X, i32Y;
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        //
+        // The window wraps the cursor onto the next row, so the whole
+        // rectangle is one burst.
+        //
+        PanelWindowSet(&psRects[ui32Idx]);
+        for(i32Y = psRects[ui32Idx].i16YMin; i32Y <= psRects[ui32Idx].i16YMax;
+            i32Y++)
+        {
+            pui16Row = BACK_BUFFER_PIXEL(psRects[ui32Idx].i16XMin, i32Y);
+            for(i32X = psRects[ui32Idx].i16XMin;
+                i32X <= psRects[ui32Idx].i16XMax; i32X++)
+            {
+                WriteData(*pui16Row++);
+            }
+        }
+    }
+
+    PanelWindowReset();
+    g_bSending = false;
+}
+
+//*****************************************************************************
+//
+// Marks a rectangle of the buffer as needing to be sent to the panel.  It is
+// merged with every dirty rectangle that is cheaper to send together with it
+// than on its own, repeating as the merged rectangle grows.
+//
+//*****************************************************************************
+static void
+DirtyAdd(const tRectangle *psRect)
+{
+    tRectangle sRect = *psRect, psSend[BACK_BUFFER_DIRTY_RECTS];
+    uint32_t ui32Idx, ui32Best, ui32Send = 0;
+    int32_t i32Growth, i32BestGrowth;
+    UInt uKey;
+
+    uKey = Task_disable();
+    while(1)
+    {
+        //
+        // Fold in the rectangles worth merging, starting over whenever the
+        // rectangle grows since it may now be worth merging with earlier
+        // ones.
+        //
+        ui32Idx = 0;
+        while(ui32Idx < g_ui32DirtyCount)
+        {
+            if(RectMergeGrowth(&sRect, &g_psDirtyRects[ui32Idx]) <=
+               BACK_BUFFER_MERGE_SLACK)
+            {
+                RectUnion(&sRect, &g_psDirtyRects[ui32Idx], &sRect);
+                g_psDirtyRects[ui32Idx] =
+                    g_psDirtyRects[--g_ui32DirtyCount];
+                ui32Idx = 0;
+            }
+            else
+            {
+                ui32Idx++;
+            }
+        }
+
+        if(g_ui32DirtyCount < BACK_BUFFER_DIRTY_RECTS)
+        {
+            break;
+        }
+
+        //
+        // There is no room left, so merge with the rectangle that grows the
+        // least, or send what there is now if even that is too costly.
+        //
+        ui32Best = 0;
+        i32BestGrowth = RectMergeGrowth(&sRect, &g_psDirtyRects[0]);
+        for(ui32Idx = 1; ui32Idx < g_ui32DirtyCount; ui32Idx++)
+        {
+            i32Growth = RectMergeGrowth(&sRect, &g_psDirtyRects[ui32Idx]);
+            if(i32Growth < i32BestGrowth)
+            {
+                ui32Best = ui32Idx;
+                i32BestGrowth = i32Growth;
+            }
+        }
+        if(!g_bSending && (i32BestGrowth >
+                           (RectArea(&sRect) +
+                            RectArea(&g_psDirtyRects[ui32Best]))))
+        {
+            ui32Send = DirtyTake(psSend);
+            break;
+        }
+        RectUnion(&sRect, &g_psDirtyRects[ui32Best], &sRect);
+        g_psDirtyRects[ui32Best] = g_psDirtyRects[--g_ui32DirtyCount];
+    }
+
+    g_psDirtyRects[g_ui32DirtyCount++] = sRect;
+    Task_restore(uKey);
+
+    if(ui32Send)
+    {
+        DirtySend(psSend, ui32Send);
+    }
+}
+
+//*****************************************************************************
+//
+// Fills a rectangle with a single color.  The part inside the buffer is drawn
+// into it and marked dirty, and anything outside goes straight to the panel.
+//
+//*****************************************************************************
+static void
+BufferRectFill(const tRectangle *psRect, uint32_t ui32Value)
+{
+    const tRectangle *psArea = &g_sBackBufferArea;
+    tRectangle sPart;
+    uint16_t *pui16Row;
+    int32_t i32X, i32Y;
+
+    if(RectIntersect(psRect, psArea, &sPart))
+    {
+        for(i32Y = sPart.i16YMin; i32Y <= sPart.i16YMax; i32Y++)
+        {
+            pui16Row = BACK_BUFFER_PIXEL(sPart.i16XMin, i32Y);
+            for(i32X = sPart.i16XMin; i32X <= sPart.i16XMax; i32X++)
+            {
+                *pui16Row++ = ui32Value;
+            }
+        }
+        DirtyAdd(&sPart);
+    }
+
+    //
+    // Draw the bands above and below the buffer, then the parts to its left
+    // and right.
+    //
+    sPart = *psRect;
+    if(sPart.i16YMin < psArea->i16YMin)
+    {
+        sPart.i16YMax = (psRect->i16YMax < psArea->i16YMin) ?
+                        psRect->i16YMax : (psArea->i16YMin - 1);
+        PanelRectFill(&sPart, ui32Value);
+        sPart.i16YMin = sPart.i16YMax + 1;
+        sPart.i16YMax = psRect->i16YMax;
+    }
+    if(sPart.i16YMin > sPart.i16YMax)
+    {
+        return;
+    }
+    if(sPart.i16YMax > psArea->i16YMax)
+    {
+        tRectangle sBelow = sPart;
+
+        sBelow.i16YMin = (sPart.i16YMin > psArea->i16YMax) ?
+                         sPart.i16YMin : (psArea->i16YMax + 1);
+        PanelRectFill(&sBelow, ui32Value);
+        sPart.i16YMax = sBelow.i16YMin - 1;
+    }
+    if(sPart.i16YMin > sPart.i16YMax)
+    {
+        return;
+    }
+    if(sPart.i16XMin < psArea->i16XMin)
+    {
+        tRectangle sLeft = sPart;
+
+        sLeft.i16XMax = (sPart.i16XMax < psArea->i16XMin) ?
+                        sPart.i16XMax : (psArea->i16XMin - 1);
+        PanelRectFill(&sLeft, ui32Value);
+    }
+    if(sPart.i16XMax > psArea->i16XMax)
+    {
+        tRectangle sRight = sPart;
+
+        sRight.i16XMin = (sPart.i16XMin > psArea->i16XMax) ?
+                         sPart.i16XMin : (psArea->i16XMax + 1);
+        PanelRectFill(&sRight, ui32Value);
+    }
+}
+
+//*****************************************************************************
+//
+// Writes a horizontal run of translated pixels straight to the panel.
+//
+//*****************************************************************************
+static void
+PanelRunWrite(int32_t i32X, int32_t i32Y, const uint16_t *pui16Pixels,
+              int32_t i32Count)
+{
+    WriteCommand(SSD2119_ENTRY_MODE_REG);
+    WriteData(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
+    WriteCommand(SSD2119_X_RAM_ADDR_REG);
+    WriteData(MAPPED_X(i32X, i32Y));
+    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
+    WriteData(MAPPED_Y(i32X, i32Y));
+    WriteCommand(SSD2119_RAM_DATA_REG);
+
+    while(i32Count--)
+    {
+        WriteData(*pui16Pixels++);
+    }
+}
+
+//*****************************************************************************
+//
+// Draws the run decoded into g_pui16Run, starting at the given pixel.  The
+// part inside the buffer is copied into it and marked dirty, and anything
+// outside goes straight to the panel.
+//
+//*****************************************************************************
+static void
+BufferRunDraw(int32_t i32X, int32_t i32Y)
+{
+    const tRectangle *psArea = &g_sBackBufferArea;
+    tRectangle sRun, sPart;
+    uint16_t *pui16Row;
+    int32_t i32Idx;
+
+    if(g_ui32RunLength == 0)
+    {
+        return;
+    }
+
+    sRun.i16XMin = i32X;
+    sRun.i16YMin = i32Y;
+    sRun.i16XMax = i32X + g_ui32RunLength - 1;
+    sRun.i16YMax = i32Y;
+
+    if(!RectIntersect(&sRun, psArea, &sPart))
+    {
+        PanelRunWrite(i32X, i32Y, g_pui16Run, g_ui32RunLength);
+        return;
+    }
+
+    pui16Row = BACK_BUFFER_PIXEL(sPart.i16XMin, i32Y);
+    for(i32Idx = sPart.i16XMin - i32X; i32Idx <= sPart.i16XMax - i32X;
+        i32Idx++)
+    {
+        *pui16Row++ = g_pui16Run[i32Idx];
+    }
+    DirtyAdd(&sPart);
+
+    if(sRun.i16XMin < sPart.i16XMin)
+    {
+        PanelRunWrite(i32X, i32Y, g_pui16Run, sPart.i16XMin - i32X);
+    }
+    if(sRun.i16XMax > sPart.i16XMax)
+    {
+        PanelRunWrite(sPart.i16XMax + 1, i32Y,
+                      &g_pui16Run[sPart.i16XMax + 1 - i32X],
+                      sRun.i16XMax - sPart.i16XMax);
+    }
+}
+
+//*****************************************************************************
+//
+// Writes the next pixel of PixelDrawMultiple() into the run.
+//
+//*****************************************************************************
+static inline void
+PixelWrite(uint16_t ui16Data)
+{
+    if(g_ui32RunLength < DISPLAY_WIDTH)
+    {
+        g_pui16Run[g_ui32RunLength++] = ui16Data;
+    }
+}
+#else
+//*****************************************************************************
+//
+// Writes the next pixel of PixelDrawMultiple() to the SSD2119.
+//
+//*****************************************************************************
+static inline void
+PixelWrite(uint16_t ui16Data)
+{
+    WriteData(ui16Data);
+}
+#endif
+
 //*****************************************************************************
 //
 //! Draws a pixel on the screen.
@@ -328,6 +921,16 @@ static void
 Kentec320x240x16_SSD2119PixelDraw(void *pvDisplayData, int32_t i32X,
                                   int32_t i32Y, uint32_t ui32Value)
 {
+#ifdef SSD2119_BACK_BUFFER
+    tRectangle sRect;
+
+    //
+    // Draw the pixel into the buffer if it is there.
+    //
+    sRect.i16XMin = sRect.i16XMax = i32X;
+    sRect.i16YMin = sRect.i16YMax = i32Y;
+    BufferRectFill(&sRect, ui32Value);
+#else
     //
     // Set the X address of the display cursor.
     //
@@ -345,6 +948,7 @@ Kentec320x240x16_SSD2119PixelDraw(void *pvDisplayData, int32_t i32X,
     //
     WriteCommand(SSD2119_RAM_DATA_REG);
     WriteData(ui32Value);
+#endif
 }
 
 //*****************************************************************************
@@ -381,6 +985,12 @@ Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int32_t i32X,
 {
     uint32_t ui32Byte;
 
+#ifdef SSD2119_BACK_BUFFER
+    //
+    // Decode the pixels into a run, which is copied into the buffer below.
+    //
+    g_ui32RunLength = 0;
+#else
     //
     // Set the cursor increment to left to right, followed by top to bottom.
     //
@@ -403,6 +1013,7 @@ Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int32_t i32X,
     // Write the data RAM write command.
     //
     WriteCommand(SSD2119_RAM_DATA_REG);
+#endif
 
     //
     // Determine how to interpret the pixel data based on the number of bits
@@ -433,7 +1044,7 @@ Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int32_t i32X,
                     //
                     // Draw this pixel in the appropriate color.
                     //
-                    WriteData(((uint32_t *)pui8Palette)[(ui32Byte >>
+                    PixelWrite(((uint32_t *)pui8Palette)[(ui32Byte >>
                                                          (7 - i32X0)) & 1]);
                 }
 
@@ -481,7 +1092,7 @@ Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int32_t i32X,
                         // Translate this palette entry and write it to the
                         // screen.
                         //
-                        WriteData(DPYCOLORTRANSLATE(ui32Byte));
+                        PixelWrite(DPYCOLORTRANSLATE(ui32Byte));
 
                         //
                         // Decrement the count of pixels to draw.
@@ -507,7 +1118,7 @@ Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int32_t i32X,
                             // Translate this palette entry and write it to the
                             // screen.
                             //
-                            WriteData(DPYCOLORTRANSLATE(ui32Byte));
+                            PixelWrite(DPYCOLORTRANSLATE(ui32Byte));
 
                             //
                             // Decrement the count of pixels to draw.
@@ -543,7 +1154,7 @@ Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int32_t i32X,
                 //
                 // Translate this palette entry and write it to the screen.
                 //
-                WriteData(DPYCOLORTRANSLATE(ui32Byte));
+                PixelWrite(DPYCOLORTRANSLATE(ui32Byte));
             }
 
             //
@@ -552,6 +1163,10 @@ Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int32_t i32X,
             break;
         }
     }
+
+#ifdef SSD2119_BACK_BUFFER
+    BufferRunDraw(i32X, i32Y);
+#endif
 }
 
 //*****************************************************************************
@@ -576,6 +1191,14 @@ Kentec320x240x16_SSD2119LineDrawH(void *pvDisplayData, int32_t i32X1,
                                   int32_t i32X2, int32_t i32Y,
                                   uint32_t ui32Value)
 {
+#ifdef SSD2119_BACK_BUFFER
+    tRectangle sRect;
+
+    sRect.i16XMin = i32X1;
+    sRect.i16XMax = i32X2;
+    sRect.i16YMin = sRect.i16YMax = i32Y;
+    BufferRectFill(&sRect, ui32Value);
+#else
     //
     // Set the cursor increment to left to right, followed by top to bottom.
     //
@@ -609,6 +1232,7 @@ Kentec320x240x16_SSD2119LineDrawH(void *pvDisplayData, int32_t i32X1,
         //
         WriteData(ui32Value);
     }
+#endif
 }
 
 //*****************************************************************************
@@ -633,6 +1257,14 @@ Kentec320x240x16_SSD2119LineDrawV(void *pvDisplayData, int32_t i32X,
                                   int32_t i32Y1, int32_t i32Y2,
                                   uint32_t ui32Value)
 {
+#ifdef SSD2119_BACK_BUFFER
+    tRectangle sRect;
+
+    sRect.i16XMin = sRect.i16XMax = i32X;
+    sRect.i16YMin = i32Y1;
+    sRect.i16YMax = i32Y2;
+    BufferRectFill(&sRect, ui32Value);
+#else
     //
     // Set the cursor increment to top to bottom, followed by left to right.
     //
@@ -666,6 +1298,7 @@ Kentec320x240x16_SSD2119LineDrawV(void *pvDisplayData, int32_t i32X,
         //
         WriteData(ui32Value);
     }
+#endif
 }
 
 //*****************************************************************************
@@ -689,83 +1322,11 @@ static void
 Kentec320x240x16_SSD2119RectFill(void *pvDisplayData, const tRectangle *psRect,
                                  uint32_t ui32Value)
 {
-    int32_t i32Count;
-
-    //
-    // Write the Y extents of the rectangle.
-    //
-    WriteCommand(SSD2119_ENTRY_MODE_REG);
-    WriteData(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
-
-    //
-    // Write the X extents of the rectangle.
-    //
-    WriteCommand(SSD2119_H_RAM_START_REG);
-#if (defined PORTRAIT) || (defined LANDSCAPE)
-    WriteData(MAPPED_X(psRect->i16XMax, psRect->i16YMax));
-#else
-    WriteData(MAPPED_X(psRect->i16XMin, psRect->i16YMin));
-#endif
-
-    WriteCommand(SSD2119_H_RAM_END_REG);
-#if (defined PORTRAIT) || (defined LANDSCAPE)
-    WriteData(MAPPED_X(psRect->i16XMin, psRect->i16YMin));
-#else
-    WriteData(MAPPED_X(psRect->i16XMax, psRect->i16YMax));
-#endif
-
-    //
-    // Write the Y extents of the rectangle
-    //
-    WriteCommand(SSD2119_V_RAM_POS_REG);
-#if (defined LANDSCAPE_FLIP) || (defined PORTRAIT)
-    WriteData(MAPPED_Y(psRect->i16XMin, psRect->i16YMin) |
-             (MAPPED_Y(psRect->i16XMax, psRect->i16YMax) << 8));
+#ifdef SSD2119_BACK_BUFFER
+    BufferRectFill(psRect, ui32Value);
 #else
-    WriteData(MAPPED_Y(psRect->i16XMax, psRect->i16YMax) |
-             (MAPPED_Y(psRect->i16XMin, psRect->i16YMin) << 8));
+    PanelRectFill(psRect, ui32Value);
 #endif
-
-    //
-    // Set the display cursor to the upper left of the rectangle (in
-    // application coordinate space).
-    //
-    WriteCommand(SSD2119_X_RAM_ADDR_REG);
-    WriteData(MAPPED_X(psRect->i16XMin, psRect->i16YMin));
-    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
-    WriteData(MAPPED_Y(psRect->i16XMin, psRect->i16YMin));
-
-    //
-    // Tell the controller to write data into its RAM.
-    //
-    WriteCommand(SSD2119_RAM_DATA_REG);
-
-    //
-    // Loop through the pixels of this filled rectangle.
-    //
-    for(i32Count = ((psRect->i16XMax - psRect->i16XMin + 1) *
-                    (psRect->i16YMax - psRect->i16YMin + 1)); i32Count >= 0;
-        i32Count--)
-    {
-        //
-        // Write the pixel value.
-        //
-        WriteData(ui32Value);
-    }
-
-    //
-    // Reset the X extents to the entire screen.
-    //
-    WriteCommand(SSD2119_H_RAM_START_REG);
-    WriteData(0x0000);
-    WriteCommand(SSD2119_H_RAM_END_REG);
-    WriteData(0x013f);
-
-    //
-    // Reset the Y extent to the full screen
-    //
-    WriteCommand(SSD2119_V_RAM_POS_REG);
-    WriteData(0xef00);
 }
 
 //*****************************************************************************
@@ -803,8 +1364,10 @@ Kentec320x240x16_SSD2119ColorTranslate(void *pvDisplayData, uint32_t ui32Value)
 //!
 //! This functions flushes any cached drawing operations to the display.  This
 //! is useful when a local frame buffer is used for drawing operations, and the
-//! flush would copy the local frame buffer to the display.  For the SSD2119
-//! driver, the flush is a no operation.
+//! flush would copy the local frame buffer to the display.  Without
+//! SSD2119_BACK_BUFFER, the flush is a no operation.  With it, each dirty
+//! rectangle of the buffer is sent to the panel with one window setup and a
+//! single burst of pixel writes.  It may be called from any task.
 //!
 //! \return None.
 //
@@ -812,9 +1375,32 @@ Kentec320x240x16_SSD2119ColorTranslate(void *pvDisplayData, uint32_t ui32Value)
 static void
 Kentec320x240x16_SSD2119Flush(void *pvDisplayData)
 {
+#ifdef SSD2119_BACK_BUFFER
+    tRectangle psSend[BACK_BUFFER_DIRTY_RECTS];
+    uint32_t ui32Send = 0;
+    UInt uKey;
+
+    //
+    // Take the list under the lock, so a task drawing meanwhile adds to a
+    // fresh one rather than having its rectangles cleared unsent.  If another
+    // task is already sending, what is left goes out on the next flush.
+    //
+    uKey = Task_disable();
+    if(!g_bSending)
+    {
+        ui32Send = DirtyTake(psSend);
+    }
+    Task_restore(uKey);
+
+    if(ui32Send)
+    {
+        DirtySend(psSend, ui32Send);
+    }
+#else
     //
     // There is nothing to be done.
     //
+#endif
 }
 
 //*****************************************************************************
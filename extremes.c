@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "extremes.h"
+
+static void deque_push(ExtremesDeque *deque, uint32_t index, uint32_t value, bool largest);
+static void deque_expire(ExtremesDeque *deque, uint32_t oldest);
+
+void extremes_init(SlidingExtremes *extremes, uint8_t window) {
+    if (window == 0) {
+        window = 1;
+    } else if (window > EXTREMES_MAX_WINDOW) {
+        window = EXTREMES_MAX_WINDOW;
+    }
+
+    extremes->window = window;
+    extremes->next = 0;
+    extremes->largest.head = 0;
+    extremes->largest.count = 0;
+    extremes->smallest.head = 0;
+    extremes->smallest.count = 0;
+}
+
+/**
+ * Adds the newest sample, dropping the one that falls out of the window.
+ */
+void extremes_push(SlidingExtremes *extremes, uint32_t value) {
+    uint32_t index = extremes->next++;
+
+    // expiring first keeps each deque within the window, and so its storage
+    if (index >= extremes->window) {
+        deque_expire(&extremes->largest, index - extremes->window + 1);
+        deque_expire(&extremes->smallest, index - extremes->window + 1);
+    }
+
+    deque_push(&extremes->largest, index, value, true);
+    deque_push(&extremes->smallest, index, value, false);
+}
+
+bool extremes_empty(const SlidingExtremes *extremes) {
+    return extremes->largest.count == 0;
+}
+
+// 0 before the first sample
+uint32_t extremes_largest(const SlidingExtremes *extremes) {
+    const ExtremesDeque *deque = &extremes->largest;
+    return deque->count > 0 ? deque->entries[deque->head].value : 0;
+}
+
+uint32_t extremes_smallest(const SlidingExtremes *extremes) {
+    const ExtremesDeque *deque = &extremes->smallest;
+    return deque->count > 0 ? deque->entries[deque->head].value : 0;
+}
+
+/**
+ * Removes entries from the back that the new value beats, since they leave
+ * the window before it and can never be the extreme again, then appends it.
+ */
+static void deque_push(ExtremesDeque *deque, uint32_t index, uint32_t value, bool largest) {
+    uint8_t back;
+
+    while (deque->count > 0) {
+        back = (deque->head + deque->count - 1) % EXTREMES_MAX_WINDOW;
+        if (largest ? deque->entries[back].value > value : deque->entries[back].value < value) {
+            break;
+        }
+        deque->count--;
+    }
+
+    back = (deque->head + deque->count) % EXTREMES_MAX_WINDOW;
+    deque->entries[back].index = index;
+    deque->entries[back].value = value;
+    deque->count++;
+}
+
+// drops entries from the front that are older than the window
+static void deque_expire(ExtremesDeque *deque, uint32_t oldest) {
+    while (deque->count > 0 && deque->entries[deque->head].index < oldest) {
+        deque->head = (deque->head + 1) % EXTREMES_MAX_WINDOW;
+        deque->count--;
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef EXTREMES_H
+#define EXTREMES_H
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EXTREMES_MAX_WINDOW 64
+
+typedef struct ExtremesEntry {
+    uint32_t index; // position of the sample in the stream
+    uint32_t value;
+} ExtremesEntry;
+
+// ring buffer of entries, front is the extreme of the window
+typedef struct ExtremesDeque {
+    ExtremesEntry entries[EXTREMES_MAX_WINDOW];
+    uint8_t head;
+    uint8_t count;
+} ExtremesDeque;
+
+/**
+ * Smallest and largest of the newest window samples. Each deque only keeps
+ * the samples that can still become the extreme, in order, so a push costs
+ * O(1) amortised and reading either extreme is O(1).
+ */
+typedef struct SlidingExtremes {
+    ExtremesDeque largest;  // values decreasing from the front
+    ExtremesDeque smallest; // values increasing from the front
+    uint32_t next;
+    uint8_t window;
+} SlidingExtremes;
+
+void extremes_init(SlidingExtremes *extremes, uint8_t window);
+void extremes_push(SlidingExtremes *extremes, uint32_t value);
+bool extremes_empty(const SlidingExtremes *extremes);
+uint32_t extremes_largest(const SlidingExtremes *extremes);
+uint32_t extremes_smallest(const SlidingExtremes *extremes);
+#endif // EXTREMES_H
@@ -0,0 +1,128 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "history.h"
+
+/**
+ * Sets up a history over the given storage, keeping as many samples as the
+ * storage holds.
+ */
+void history_init(History *history, HistorySample *storage, uint16_t capacity) {
+    history->samples = storage;
+    history->capacity = capacity;
+    history->depth = capacity;
+    history_clear(history);
+}
+
+/**
+ * Changes how many samples are kept, up to the storage capacity. The stored
+ * samples no longer line up with the new depth, so they are dropped.
+ */
+void history_set_depth(History *history, uint16_t depth) {
+    if (depth == 0) {
+        depth = 1;
+    } else if (depth > history->capacity) {
+        depth = history->capacity;
+    }
+    history->depth = depth;
+    history_clear(history);
+}
+
+void history_clear(History *history) {
+    history->head = 0;
+    history->count = 0;
+    history->appended = 0;
+}
+
+void history_append(History *history, uint32_t time, uint32_t value) {
+    HistorySample *sample = &history->samples[history->head];
+
+    sample->time = time;
+    sample->value = value;
+
+    history->head++;
+    if (history->head >= history->depth) {
+        history->head = 0;
+    }
+    if (history->count < history->depth) {
+        history->count++;
+    }
+    history->appended++;
+}
+
+uint16_t history_count(const History *history) {
+    return history->count;
+}
+
+/**
+ * Returns how many samples have been appended since the history was last
+ * cleared. The newest sample is number history_appended() - 1.
+ */
+uint32_t history_appended(const History *history) {
+    return history->appended;
+}
+
+/**
+ * Copies out the most recent sample. Returns false if there isn't one yet.
+ */
+bool history_latest(const History *history, HistorySample *sample) {
+    uint16_t index;
+
+    if (history->count == 0) {
+        return false;
+    }
+
+    index = history->head == 0 ? history->depth - 1 : history->head - 1;
+    *sample = history->samples[index];
+    return true;
+}
+
+/**
+ * Starts an iterator over the newest samples (all of them if fewer are kept),
+ * oldest first. Appending while iterating overwrites the samples still to
+ * come, so take a snapshot if the history can change underneath.
+ */
+void history_iterate(const History *history, uint16_t newest, HistoryIterator *iterator) {
+    if (newest > history->count) {
+        newest = history->count;
+    }
+
+    iterator->history = history;
+    iterator->remaining = newest;
+    iterator->index = history->head >= newest
+        ? history->head - newest
+        : history->head + history->depth - newest;
+}
+
+/**
+ * Copies out the next sample. Returns false once all of them have been seen.
+ */
+bool history_next(HistoryIterator *iterator, HistorySample *sample) {
+    const History *history = iterator->history;
+
+    if (iterator->remaining == 0) {
+        return false;
+    }
+
+    *sample = history->samples[iterator->index];
+    iterator->index++;
+    if (iterator->index >= history->depth) {
+        iterator->index = 0;
+    }
+    iterator->remaining--;
+    return true;
+}
+
+/**
+ * Copies the newest samples into a flat array, oldest first, and returns how
+ * many were copied.
+ */
+uint16_t history_snapshot(const History *history, HistorySample *samples, uint16_t newest) {
+    HistoryIterator iterator;
+    uint16_t copied = 0;
+
+    history_iterate(history, newest, &iterator);
+    while (history_next(&iterator, &samples[copied])) {
+        copied++;
+    }
+    return copied;
+}
@@ -0,0 +1,42 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+#include <stdint.h>
+#include <stdbool.h>
+
+// a single timestamped reading
+typedef struct HistorySample {
+    uint32_t time; // ms since boot
+    uint32_t value;
+} HistorySample;
+
+/**
+ * Fixed size ring buffer of samples. Appending overwrites the oldest sample
+ * once the buffer is full, so it never copies what is already stored.
+ */
+typedef struct History {
+    HistorySample *samples; // storage, owned by the caller
+    uint16_t capacity;      // samples the storage can hold
+    uint16_t depth;         // samples kept, at most capacity
+    uint16_t head;          // where the next sample goes
+    uint16_t count;         // samples currently kept
+    uint32_t appended;      // samples ever appended, numbers the samples
+} History;
+
+// walks samples oldest first, see history_iterate()
+typedef struct HistoryIterator {
+    const History *history;
+    uint16_t index;
+    uint16_t remaining;
+} HistoryIterator;
+
+void history_init(History *history, HistorySample *storage, uint16_t capacity);
+void history_set_depth(History *history, uint16_t depth);
+void history_clear(History *history);
+void history_append(History *history, uint32_t time, uint32_t value);
+uint16_t history_count(const History *history);
+uint32_t history_appended(const History *history);
+bool history_latest(const History *history, HistorySample *sample);
+void history_iterate(const History *history, uint16_t newest, HistoryIterator *iterator);
+bool history_next(HistoryIterator *iterator, HistorySample *sample);
+uint16_t history_snapshot(const History *history, HistorySample *samples, uint16_t newest);
+#endif // HISTORY_H
@@ -0,0 +1,94 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "motor/filter.h"
+
+#define SAMPLES 4096 // a power of two, the input is replayed from this table
+#define UPDATES 20000000
+
+/*
+ * Host timings of each filter's update, in nanoseconds per sample. These are
+ * for comparing the filters and window sizes against each other; the target
+ * costs come from the cycle counter (see timing.h).
+ */
+static float input[SAMPLES];
+static volatile float sink;
+
+static double Now() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void Report(const char *name, double start) {
+    printf("  %-28s %6.2f ns/update\n", name, (Now() - start) * 1e9 / UPDATES);
+}
+
+static void BenchMovingAverage(uint8_t window) {
+    MovingAverage filter;
+    char name[32];
+    double start;
+    int n;
+
+    MovingAverageInit(&filter, window);
+    start = Now();
+    for (n = 0; n < UPDATES; n++) {
+        sink = MovingAverageUpdate(&filter, input[n & (SAMPLES - 1)]);
+    }
+    snprintf(name, sizeof(name), "moving average, window %u", window);
+    Report(name, start);
+}
+
+static void BenchLowPass() {
+    LowPassFilter filter;
+    double start;
+    int n;
+
+    LowPassInit(&filter, 0.05f);
+    start = Now();
+    for (n = 0; n < UPDATES; n++) {
+        sink = LowPassUpdate(&filter, input[n & (SAMPLES - 1)]);
+    }
+    Report("low pass", start);
+}
+
+/*
+ * On a falling ramp the sample leaving the window is the largest and the new
+ * one the smallest, so each update searches the whole sorted window and then
+ * shifts across all of it, the worst case on the target. A host's branch predictor learns the pattern, so here it
+ * comes out faster than random input.
+ */
+static void BenchMedian(uint8_t window, int descending) {
+    MedianFilter filter;
+    char name[40];
+    double start;
+    int n;
+
+    MedianInit(&filter, window);
+    start = Now();
+    for (n = 0; n < UPDATES; n++) {
+        sink = MedianUpdate(&filter, descending ? (float)-n : input[n & (SAMPLES - 1)]);
+    }
+    snprintf(name, sizeof(name), "median, window %u, %s", window, descending ? "descending" : "random");
+    Report(name, start);
+}
+
+int main() {
+    int i;
+
+    srand(1);
+    for (i = 0; i < SAMPLES; i++) {
+        input[i] = 100 + 20 * ((float)rand() / RAND_MAX - 0.5f);
+    }
+
+    BenchMovingAverage(8);
+    BenchMovingAverage(FILTER_MAX_WINDOW);
+    BenchLowPass();
+    for (i = 3; i <= FILTER_MAX_MEDIAN; i += 2) {
+        BenchMedian(i, 0);
+        BenchMedian(i, 1);
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "motor/pi_control.h"
+
+#define ERRORS 4096 // a power of two, the speed errors are replayed from this table
+#define UPDATES 20000000
+
+/*
+ * Host timings of the fixed point speed PI against the double precision one
+ * it replaced, in nanoseconds per update. The fixed point one also rate
+ * limits and back-calculates, and a host does doubles in hardware, so here it
+ * comes out slower. On the M4F every double add, multiply and compare is a
+ * library call; the firmware benchmark (benchmark.c) times both there, in
+ * cycles.
+ */
+static int32_t errors[ERRORS];
+static volatile int32_t fixed_sink;
+static volatile double double_sink;
+
+// the speed PI as it was in speed.c
+#define DOUBLE_MAX_INCREMENT 0.00001
+#define DOUBLE_KP (DOUBLE_MAX_INCREMENT / 100)
+#define DOUBLE_KI (DOUBLE_KP / 100)
+#define DOUBLE_MAX_ERROR_SUM 10
+#define DOUBLE_MAX_DUTY 0.95
+
+static double error_sum = 0, duty_cycle = 0;
+
+static double DoublePIUpdate(double error) {
+    double duty_inc;
+
+    error_sum += error;
+    duty_inc = DOUBLE_KP * error + DOUBLE_KI * error_sum;
+    if (error_sum >= DOUBLE_MAX_ERROR_SUM) {
+        error_sum = DOUBLE_MAX_ERROR_SUM;
+    }
+    if (duty_inc >= DOUBLE_MAX_INCREMENT) {
+        duty_inc = DOUBLE_MAX_INCREMENT;
+    } else if (duty_inc <= -DOUBLE_MAX_INCREMENT) {
+        duty_inc = -DOUBLE_MAX_INCREMENT;
+    }
+    duty_cycle += duty_inc;
+    if (duty_cycle >= DOUBLE_MAX_DUTY) {
+        duty_cycle = DOUBLE_MAX_DUTY;
+    }
+    return duty_cycle;
+}
+
+static double Now() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void Report(const char *name, double start) {
+    printf("  %-28s %6.2f ns/update\n", name, (Now() - start) * 1e9 / UPDATES);
+}
+
+/*
+ * Speed loop gains and limits from speed.c (direct duty mode).
+ */
+static void BenchFixed() {
+    PIController pi;
+    double start;
+    int n;
+
+    PIControllerInit(&pi, PI_FROM_FLOAT(0.00003), PI_FROM_FLOAT(0.0000003), 0, PI_FROM_FLOAT(0.95));
+    PIControllerSetLimits(&pi, 0, PI_FROM_FLOAT(0.95), PI_FROM_FLOAT(0.95), PI_FROM_FLOAT(0.0005));
+    start = Now();
+    for (n = 0; n < UPDATES; n++) {
+        fixed_sink = PIControllerUpdate(&pi, errors[n & (ERRORS - 1)]);
+    }
+    Report("fixed point PI", start);
+}
+
+static void BenchDouble() {
+    double start;
+    int n;
+
+    start = Now();
+    for (n = 0; n < UPDATES; n++) {
+        double_sink = DoublePIUpdate(errors[n & (ERRORS - 1)]);
+    }
+    Report("double PI", start);
+}
+
+int main() {
+    int i;
+
+    // steps of a few hundred RPM either way with measurement noise on top
+    srand(1);
+    for (i = 0; i < ERRORS; i++) {
+        errors[i] = ((i / 512) % 2 ? 300 : -300) + rand() % 41 - 20;
+    }
+
+    BenchFixed();
+    BenchDouble();
+    return 0;
+}
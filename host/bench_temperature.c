@@ -0,0 +1,140 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+// CalculateTemperature() and the calibration constants are static, so the
+// module is built into the benchmark
+#include "motor/temperature.c"
+
+#define READINGS 4096 // a power of two, the readings are replayed from this table
+#define CONVERSIONS 5000000
+
+/*
+ * Host timings of the single precision object temperature conversion against
+ * the double precision one with pow() it replaced, in nanoseconds per
+ * conversion. A host does doubles and pow() quickly, so the gap here is
+ * smaller than on the M4F, where the FPU only handles single precision and
+ * every double operation and pow() call goes through the runtime library.
+ */
+typedef struct Reading {
+    int16_t RAM_6, RAM_9, RAM_A, RAM_B;
+} Reading;
+
+static Reading readings[READINGS];
+static volatile float float_sink;
+static volatile double double_sink;
+
+// calibration from the Melexis driver library example, as in test_temperature.c
+static const int32_t RAW_PR = 0x00587F5B, RAW_PG = 0x04A10289, RAW_PT = (int32_t)0xFFF966F8;
+static const int32_t RAW_PO = 0x00001E0F, RAW_FA = 53855361, RAW_FB = 42874149, RAW_GA = -14556410;
+static const int16_t RAW_GB = 9728, RAW_KA = 10752, RAW_HA = 16384, RAW_HB = 1638;
+
+static double Gb_d, Ka_d, Ha_d, Hb_d, Fa_d, Fb_d, Ga_d, Pr_d, Po_d, Pg_d, Pt_d;
+
+static void LoadCalibration() {
+    Gb = RAW_GB * SCALE(10);
+    Ka = RAW_KA * SCALE(10);
+    Hb = RAW_HB * SCALE(14);
+    Fb = RAW_FB * SCALE(36);
+    Ga = RAW_GA * SCALE(36);
+    Pr = RAW_PR * SCALE(8);
+    Po = RAW_PO * SCALE(8);
+    Pt = RAW_PT * SCALE(44);
+    FaHa = (RAW_FA * SCALE(46)) * (RAW_HA * SCALE(14));
+    inverse_Pg = 1.0f / (RAW_PG * SCALE(20));
+
+    Gb_d = RAW_GB * pow(2, -10);
+    Ka_d = RAW_KA * pow(2, -10);
+    Ha_d = RAW_HA * pow(2, -14);
+    Hb_d = RAW_HB * pow(2, -14);
+    Fa_d = RAW_FA * pow(2, -46);
+    Fb_d = RAW_FB * pow(2, -36);
+    Ga_d = RAW_GA * pow(2, -36);
+    Pr_d = RAW_PR * pow(2, -8);
+    Po_d = RAW_PO * pow(2, -8);
+    Pg_d = RAW_PG * pow(2, -20);
+    Pt_d = RAW_PT * pow(2, -44);
+}
+
+/*
+ * The conversion as it was in temperature.c, in double precision with pow().
+ */
+static double DoubleTemperature(double temperature_old, int16_t RAM_6, int16_t RAM_9, int16_t RAM_A, int16_t RAM_B) {
+    double VRTA, AMB, Ta_C, Ta_K, S, VRTO, STO, To_K;
+
+    VRTA = RAM_9 + Gb_d * (RAM_6 / 12.0);
+    AMB = ((RAM_6 / 12.0) / VRTA) * pow(2, 19);
+    Ta_C = Po_d + ((AMB - Pr_d) / Pg_d) + Pt_d * pow((AMB - Pr_d), 2);
+    Ta_K = Ta_C + KELVIN_OFFSET;
+    S = (RAM_A + RAM_B) / 2.0;
+    VRTO = RAM_9 + Ka_d * (RAM_6 / 12.0);
+    STO = ((S / 12.0) / VRTO) * pow(2, 19);
+    To_K = (STO / (Fa_d * Ha_d * (1.0 + Ga_d * (temperature_old - TO_O) + Fb_d * (Ta_C - TA_O)))) + pow(Ta_K, 4);
+    return pow(To_K, 0.25) - KELVIN_OFFSET - Hb_d;
+}
+
+static double Now() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void Report(const char *name, double start) {
+    printf("  %-28s %6.2f ns/conversion\n", name, (Now() - start) * 1e9 / CONVERSIONS);
+}
+
+/*
+ * Each conversion feeds the last result back in as the previous object
+ * temperature, as UpdateTemperature() does.
+ */
+static void BenchFloat() {
+    Reading *reading;
+    float temperature = 25;
+    double start;
+    int n;
+
+    start = Now();
+    for (n = 0; n < CONVERSIONS; n++) {
+        reading = &readings[n & (READINGS - 1)];
+        temperature = CalculateTemperature(temperature, 0, reading->RAM_6, reading->RAM_9,
+                                           reading->RAM_A, reading->RAM_B);
+    }
+    float_sink = temperature;
+    Report("single precision", start);
+}
+
+static void BenchDouble() {
+    Reading *reading;
+    double temperature = 25, start;
+    int n;
+
+    start = Now();
+    for (n = 0; n < CONVERSIONS; n++) {
+        reading = &readings[n & (READINGS - 1)];
+        temperature = DoubleTemperature(temperature, reading->RAM_6, reading->RAM_9,
+                                        reading->RAM_A, reading->RAM_B);
+    }
+    double_sink = temperature;
+    Report("double precision, pow()", start);
+}
+
+int main() {
+    int i;
+
+    // readings around a warm motor in a room, with noise on every word
+    srand(1);
+    for (i = 0; i < READINGS; i++) {
+        readings[i].RAM_6 = 22800 + rand() % 401 - 200;
+        readings[i].RAM_9 = 19000 + rand() % 41 - 20;
+        readings[i].RAM_A = 900 + rand() % 201 - 100;
+        readings[i].RAM_B = 900 + rand() % 201 - 100;
+    }
+
+    LoadCalibration();
+    BenchFloat();
+    BenchDouble();
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef HOST_CHECK_H_
+#define HOST_CHECK_H_
+
+#include <stdio.h>
+
+/*
+ * Minimal assertions for the host tests. A failed check is reported and
+ * counted, the test carries on, and the process exits non-zero at the end.
+ */
+static int check_failures = 0;
+
+#define CHECK(condition) do { \
+        if (!(condition)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            check_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) do { \
+        double check_actual_ = (actual), check_expected_ = (expected); \
+        double check_error_ = check_actual_ - check_expected_; \
+        if (check_error_ > (tolerance) || -check_error_ > (tolerance)) { \
+            printf("%s:%d: %s = %g, expected %g within %g\n", __FILE__, __LINE__, \
+                   #actual, check_actual_, check_expected_, (double)(tolerance)); \
+            check_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_DONE() (printf("%s: %s\n", __FILE__, check_failures ? "FAILED" : "passed"), check_failures != 0)
+
+#endif /* HOST_CHECK_H_ */
@@ -0,0 +1,557 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <driverlib/gpio.h>
+#include <driverlib/timer.h>
+#include <driverlib/pwm.h>
+#include <driverlib/adc.h>
+#include <driverlib/udma.h>
+#include <inc/hw_memmap.h>
+#include "motor/motorLib.h"
+#include "motor/acquisition.h"
+#include "motor/timing.h"
+#include "peripherals.h"
+
+/*
+ * The microcontroller as the firmware sees it, wired to the simulated motor.
+ * These override the do nothing versions in stubs/stubs.c for the pins,
+ * timers, PWM generators, ADC and uDMA that speed.c, motorLib.c and
+ * acquisition.c use, and raise the hall edge and ADC interrupts between
+ * plant steps. Firmware code takes no simulated time, so every cycle count
+ * it measures reads 0.
+ *
+ * Wiring, from motorLib.h and acquisition.c:
+ *   H1 on PL3, H2 on PP4, H3 on PP5, fault lines PC6 and PL2 (high is healthy)
+ *   reset lines A PA7, B PL5, C PL4 (high lets the half bridge switch)
+ *   ADC1 CH0 (PE3) the current sensor, 2.5 V + 0.2 V/A of DC bus current,
+ *   any other ADC input reads 0 V
+ */
+#define SENSOR_ZERO 2.5       // volts out of the current sensor at 0 A
+#define SENSOR_GAIN 0.2       // volts per amp
+#define ADC_REFERENCE 3.3
+#define ADC_COUNTS 4095
+#define ADC_NOISE 2           // counts either side, uniform
+#define MAX_STEPS 8
+
+typedef struct TimerHalf {
+    uint32_t base;
+    uint32_t half;
+    uint32_t load;
+    uint32_t match;
+    bool invert;
+    bool enabled;
+} TimerHalf;
+
+typedef struct DmaBuffer {
+    uint16_t *destination;
+    uint32_t count;
+    uint32_t index;
+    uint32_t mode;
+} DmaBuffer;
+
+typedef struct GpioPort {
+    uint32_t base;
+    uint8_t output;
+    uint8_t inputs; // levels at the last edge check
+    uint8_t status;
+    uint8_t enabled;
+    void (*handler)(void);
+} GpioPort;
+
+static Plant plant;
+static uint64_t cycles = 0;
+
+static GpioPort ports[] = {
+    { .base = GPIO_PORTA_BASE }, { .base = GPIO_PORTC_BASE }, { .base = GPIO_PORTL_BASE }, { .base = GPIO_PORTP_BASE },
+};
+#define PORT_COUNT (sizeof(ports) / sizeof(ports[0]))
+
+static TimerHalf timers[] = {
+    { .base = TIMER2_BASE, .half = TIMER_A }, { .base = TIMER2_BASE, .half = TIMER_B },
+    { .base = TIMER3_BASE, .half = TIMER_A }, { .base = TIMER3_BASE, .half = TIMER_B },
+};
+#define TIMER_COUNT (sizeof(timers) / sizeof(timers[0]))
+static uint64_t timer_sync = 0;
+
+static uint32_t pwm_divider = 1, pwm_period[4], pwm_width[8], sample_trigger = 0;
+static uint8_t pwm_outputs = 0;
+static bool sample_clock_running = false;
+static uint64_t motor_pwm_sync = 0;
+
+static uint32_t adc_steps[MAX_STEPS], adc_step_count = 0;
+static bool adc_interrupt = false, adc_enabled = false, dma_enabled = false;
+static DmaBuffer dma[2];
+static uint8_t dma_active = 0;
+static uint32_t dropped = 0;
+static uint64_t next_sample = 0;
+
+static SimInterruptCost hall_cost, acquisition_cost;
+
+/*
+ * Phase A, B and C outputs, in the same order as the reset lines.
+ */
+static const uint32_t PHASE_OUTPUTS[PLANT_PHASES][2] = {
+    { MOTOR_A_TIMER }, { MOTOR_B_TIMER }, { MOTOR_C_TIMER },
+};
+static const uint32_t PHASE_RESETS[PLANT_PHASES][2] = {
+    { EGH456_RESET_A }, { EGH456_RESET_B }, { EGH456_RESET_C },
+};
+
+double SimNanoseconds() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static void Account(SimInterruptCost *cost, double start) {
+    double elapsed = SimNanoseconds() - start;
+
+    cost->count++;
+    cost->total_ns += elapsed;
+    if (elapsed > cost->max_ns) {
+        cost->max_ns = elapsed;
+    }
+}
+
+static GpioPort *Port(uint32_t base) {
+    unsigned i;
+
+    for (i = 0; i < PORT_COUNT; i++) {
+        if (ports[i].base == base) {
+            return &ports[i];
+        }
+    }
+    return 0;
+}
+
+/*
+ * Levels on the input pins of a port.
+ */
+static uint8_t PortInputs(uint32_t base) {
+    uint8_t code = PlantHallCode(&plant);
+
+    switch (base) {
+    case GPIO_PORTC_BASE:
+        return GPIO_PIN_6;
+    case GPIO_PORTL_BASE:
+        return GPIO_PIN_2 | ((code & 0b001) ? GPIO_PIN_3 : 0);
+    case GPIO_PORTP_BASE:
+        return ((code & 0b010) ? GPIO_PIN_4 : 0) | ((code & 0b100) ? GPIO_PIN_5 : 0);
+    }
+    return 0;
+}
+
+/*
+ * Duty cycle each phase's PWM output is producing, 0 while it is stopped.
+ */
+static double OutputDuty(uint32_t base, uint32_t output) {
+#ifdef MOTOR_PWM_MODULE
+    uint32_t index = output & 0x7;
+    uint32_t period = pwm_period[index / 2];
+
+    if (!(pwm_outputs & (1 << index)) || period == 0) {
+        return 0;
+    }
+    return (double)pwm_width[index] / period;
+#else
+    unsigned i;
+
+    for (i = 0; i < TIMER_COUNT; i++) {
+        if (timers[i].base == base && timers[i].half == output) {
+            const TimerHalf *timer = &timers[i];
+            double duty;
+
+            if (!timer->enabled || timer->load == 0) {
+                return 0;
+            }
+            duty = (double)timer->match / timer->load;
+            if (!timer->invert) {
+                duty = 1 - duty;
+            }
+            return duty < 0 ? 0 : (duty > 1 ? 1 : duty);
+        }
+    }
+    return 0;
+#endif
+}
+
+/*
+ * Hands the present reset lines and PWM outputs to the inverter model.
+ */
+static void UpdateInverter() {
+    int i;
+
+    for (i = 0; i < PLANT_PHASES; i++) {
+        plant.enabled[i] = (Port(PHASE_RESETS[i][0])->output & PHASE_RESETS[i][1]) != 0;
+        plant.duty[i] = OutputDuty(PHASE_OUTPUTS[i][0], PHASE_OUTPUTS[i][1]);
+    }
+}
+
+/*
+ * Where in the motor PWM period the given time falls, as the carrier value
+ * PlantBusCurrent() takes. The timers count down with inverted outputs, so
+ * each pulse ends the period. The up/down PWM generators centre each pulse on
+ * the top of the count.
+ */
+static double Carrier(uint64_t time) {
+#ifdef MOTOR_PWM_MODULE
+    double period = (double)pwm_period[1] * pwm_divider;
+    double position = (double)((time - motor_pwm_sync) % (uint64_t)period) / period;
+
+    return position < 0.5 ? 1 - 2 * position : 2 * position - 1;
+#else
+    uint32_t load = timers[0].load ? timers[0].load : 1;
+
+    return 1 - (double)((time - timer_sync) % load) / load;
+#endif
+}
+
+static uint16_t Convert(double volts) {
+    int32_t counts = (int32_t)(volts / ADC_REFERENCE * ADC_COUNTS + 0.5) + rand() % (2 * ADC_NOISE + 1) - ADC_NOISE;
+
+    return counts < 0 ? 0 : (counts > ADC_COUNTS ? ADC_COUNTS : counts);
+}
+
+/*
+ * One sequencer pass at the given time, each step's result moved by the uDMA
+ * into the active ping-pong buffer. A full buffer stops, the uDMA moves over
+ * to the other half and the sequence interrupt is raised. With both halves
+ * stopped the results are lost, as the FIFO would overflow.
+ */
+static void SamplePass(uint64_t time) {
+    double bus_current = PlantBusCurrent(&plant, Carrier(time)), start;
+    uint32_t i;
+
+    if (!adc_enabled || !dma_enabled) {
+        return;
+    }
+    for (i = 0; i < adc_step_count; i++) {
+        DmaBuffer *buffer = &dma[dma_active];
+        uint16_t value;
+
+        if ((adc_steps[i] & 0xf) == ADC_CTL_CH0) {
+            value = Convert(SENSOR_ZERO + SENSOR_GAIN * bus_current);
+        } else {
+            value = Convert(0);
+        }
+
+        if (buffer->mode != UDMA_MODE_PINGPONG) {
+            dropped++;
+            continue;
+        }
+        buffer->destination[buffer->index++] = value;
+        if (buffer->index >= buffer->count) {
+            buffer->index = 0;
+            buffer->mode = UDMA_MODE_STOP;
+            dma_active ^= 1;
+            if (adc_interrupt) {
+                start = SimNanoseconds();
+                AcquisitionADCIntHandler();
+                Account(&acquisition_cost, start);
+            }
+        }
+    }
+}
+
+/*
+ * Raises the edge interrupts for every hall input that changed.
+ */
+static void CheckHallEdges(uint8_t before) {
+    static const uint32_t HALL_PORTS[] = { GPIO_PORTL_BASE, GPIO_PORTP_BASE };
+    uint8_t changed;
+    double start;
+    unsigned i;
+
+    if (PlantHallCode(&plant) == before) {
+        return;
+    }
+    for (i = 0; i < sizeof(HALL_PORTS) / sizeof(HALL_PORTS[0]); i++) {
+        GpioPort *port = Port(HALL_PORTS[i]);
+        uint8_t now = PortInputs(port->base);
+
+        changed = now ^ port->inputs;
+        port->inputs = now;
+        port->status |= changed & (port->base == GPIO_PORTL_BASE ? GPIO_PIN_3 : (GPIO_PIN_4 | GPIO_PIN_5));
+        if ((port->status & port->enabled) && port->handler) {
+            start = SimNanoseconds();
+            port->handler();
+            Account(&hall_cost, start);
+        }
+    }
+}
+
+void SimInit(const MotorParameters *motor) {
+    unsigned i;
+
+    PlantInit(&plant, motor);
+    for (i = 0; i < PORT_COUNT; i++) {
+        ports[i].inputs = PortInputs(ports[i].base);
+    }
+    srand(1);
+}
+
+/*
+ * Cycles from the start of a sample clock period to its ADC trigger. Generator
+ * 0 counts down from its period less one, so compare A is passed width + 1
+ * clocks after the zero, or after the generator is started or synchronised.
+ */
+static uint64_t SampleOffset() {
+    if (sample_trigger == PWM_TR_CMP_AD) {
+        return (uint64_t)(pwm_width[0] + 1) * pwm_divider;
+    }
+    return 0;
+}
+
+/*
+ * Runs the motor and the peripherals for the given time.
+ */
+void SimRun(double seconds) {
+    uint64_t end = cycles + (uint64_t)(seconds * SIM_CLOCK_SPEED + 0.5);
+    uint64_t sample_period;
+    uint8_t code;
+
+    while (cycles < end) {
+        code = PlantHallCode(&plant);
+        PlantStep(&plant, (double)SIM_STEP_CYCLES / SIM_CLOCK_SPEED);
+        cycles += SIM_STEP_CYCLES;
+        CheckHallEdges(code);
+
+        sample_period = (uint64_t)pwm_period[0] * pwm_divider;
+        while (sample_clock_running && sample_period > 0 && next_sample + SampleOffset() <= cycles) {
+            SamplePass(next_sample + SampleOffset());
+            next_sample += sample_period;
+        }
+    }
+}
+
+Plant *SimPlant() {
+    return &plant;
+}
+
+uint64_t SimCycles() {
+    return cycles;
+}
+
+double SimTime() {
+    return (double)cycles / SIM_CLOCK_SPEED;
+}
+
+uint32_t SimDroppedSamples() {
+    return dropped;
+}
+
+const SimInterruptCost *SimHallCost() {
+    return &hall_cost;
+}
+
+const SimInterruptCost *SimAcquisitionCost() {
+    return &acquisition_cost;
+}
+
+/*
+ * Cycle counter, see timing.c.
+ */
+void TimingInit() {
+}
+
+uint32_t TimingNow() {
+    return (uint32_t)cycles;
+}
+
+uint32_t TimingElapsed(uint32_t since) {
+    return (uint32_t)cycles - since;
+}
+
+/*
+ * GPIO
+ */
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins) {
+    return PortInputs(ui32Port) & ui8Pins;
+}
+
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val) {
+    GpioPort *port = Port(ui32Port);
+
+    if (port) {
+        port->output = (port->output & ~ui8Pins) | (ui8Val & ui8Pins);
+        UpdateInverter();
+    }
+}
+
+void GPIOIntRegister(uint32_t ui32Port, void (*pfnIntHandler)(void)) {
+    GpioPort *port = Port(ui32Port);
+
+    if (port) {
+        port->handler = pfnIntHandler;
+    }
+}
+
+void GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags) {
+    GpioPort *port = Port(ui32Port);
+
+    if (port) {
+        port->enabled |= ui32IntFlags;
+    }
+}
+
+void GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags) {
+    GpioPort *port = Port(ui32Port);
+
+    if (port) {
+        port->enabled &= ~ui32IntFlags;
+    }
+}
+
+uint32_t GPIOIntStatus(uint32_t ui32Port, bool bMasked) {
+    GpioPort *port = Port(ui32Port);
+
+    if (!port) {
+        return 0;
+    }
+    return bMasked ? port->status & port->enabled : port->status;
+}
+
+void GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags) {
+    GpioPort *port = Port(ui32Port);
+
+    if (port) {
+        port->status &= ~ui32IntFlags;
+    }
+}
+
+/*
+ * General purpose timers in split PWM mode
+ */
+static void ForEachHalf(uint32_t base, uint32_t which, void (*apply)(TimerHalf *, uint32_t), uint32_t value) {
+    unsigned i;
+
+    for (i = 0; i < TIMER_COUNT; i++) {
+        if (timers[i].base == base && (timers[i].half & which)) {
+            apply(&timers[i], value);
+        }
+    }
+    UpdateInverter();
+}
+
+static void SetLoad(TimerHalf *timer, uint32_t value) { timer->load = value; }
+static void SetMatch(TimerHalf *timer, uint32_t value) { timer->match = value; }
+static void SetInvert(TimerHalf *timer, uint32_t value) { timer->invert = value != 0; }
+static void SetEnabled(TimerHalf *timer, uint32_t value) { timer->enabled = value != 0; }
+
+void TimerControlLevel(uint32_t ui32Base, uint32_t ui32Timer, bool bInvert) {
+    ForEachHalf(ui32Base, ui32Timer, SetInvert, bInvert);
+}
+
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer) {
+    ForEachHalf(ui32Base, ui32Timer, SetEnabled, true);
+}
+
+void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer) {
+    ForEachHalf(ui32Base, ui32Timer, SetEnabled, false);
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value) {
+    ForEachHalf(ui32Base, ui32Timer, SetLoad, ui32Value);
+}
+
+void TimerMatchSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value) {
+    ForEachHalf(ui32Base, ui32Timer, SetMatch, ui32Value);
+}
+
+void TimerSynchronize(uint32_t ui32Base, uint32_t ui32Timers) {
+    timer_sync = cycles;
+}
+
+/*
+ * PWM module. Generator 0 is the ADC sample clock, 1 to 3 drive the motor
+ * when MOTOR_PWM_MODULE is defined. Updates take effect straight away rather
+ * than at the next counter zero.
+ */
+static uint32_t Generator(uint32_t gen) {
+    return (gen - PWM_GEN_0) / (PWM_GEN_1 - PWM_GEN_0);
+}
+
+void PWMClockSet(uint32_t ui32Base, uint32_t ui32Config) {
+    pwm_divider = ui32Config == PWM_SYSCLK_DIV_8 ? 8 : 1;
+}
+
+void PWMGenPeriodSet(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Period) {
+    pwm_period[Generator(ui32Gen)] = ui32Period;
+    UpdateInverter();
+}
+
+void PWMGenEnable(uint32_t ui32Base, uint32_t ui32Gen) {
+    if (ui32Gen == PWM_GEN_0) {
+        sample_clock_running = true;
+        next_sample = cycles;
+    }
+}
+
+void PWMGenIntTrigEnable(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32IntTrig) {
+    if (ui32Gen == PWM_GEN_0) {
+        sample_trigger = ui32IntTrig;
+    }
+}
+
+void PWMPulseWidthSet(uint32_t ui32Base, uint32_t ui32PWMOut, uint32_t ui32Width) {
+    pwm_width[ui32PWMOut & 0x7] = ui32Width;
+    UpdateInverter();
+}
+
+void PWMOutputState(uint32_t ui32Base, uint32_t ui32PWMOutBits, bool bEnable) {
+    if (bEnable) {
+        pwm_outputs |= ui32PWMOutBits;
+    } else {
+        pwm_outputs &= ~ui32PWMOutBits;
+    }
+    UpdateInverter();
+}
+
+void PWMSyncTimeBase(uint32_t ui32Base, uint32_t ui32GenBits) {
+    if (ui32GenBits & PWM_GEN_0_BIT) {
+        next_sample = cycles;
+    }
+    if (ui32GenBits & ~PWM_GEN_0_BIT) {
+        motor_pwm_sync = cycles;
+    }
+}
+
+/*
+ * ADC1 sequence 0 and its uDMA channel
+ */
+void ADCSequenceStepConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum, uint32_t ui32Step, uint32_t ui32Config) {
+    if (ui32Step < MAX_STEPS) {
+        adc_steps[ui32Step] = ui32Config;
+        if (ui32Config & ADC_CTL_END) {
+            adc_step_count = ui32Step + 1;
+        }
+    }
+}
+
+void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum) {
+    adc_enabled = true;
+}
+
+void ADCIntEnableEx(uint32_t ui32Base, uint32_t ui32IntFlags) {
+    adc_interrupt = true;
+}
+
+void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Mode,
+                            void *pvSrcAddr, void *pvDstAddr, uint32_t ui32TransferSize) {
+    DmaBuffer *buffer = &dma[(ui32ChannelStructIndex & UDMA_ALT_SELECT) ? 1 : 0];
+
+    buffer->destination = pvDstAddr;
+    buffer->count = ui32TransferSize;
+    buffer->index = 0;
+    buffer->mode = ui32Mode;
+}
+
+void uDMAChannelEnable(uint32_t ui32ChannelNum) {
+    dma_enabled = true;
+}
+
+uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex) {
+    return dma[(ui32ChannelStructIndex & UDMA_ALT_SELECT) ? 1 : 0].mode;
+}
@@ -0,0 +1,29 @@
+#ifndef HOST_SIM_PERIPHERALS_H_
+#define HOST_SIM_PERIPHERALS_H_
+
+#include <stdint.h>
+#include "plant.h"
+
+#define SIM_CLOCK_SPEED 120000000 // simulated CPU clock, also the cycle counter's
+#define SIM_STEP_CYCLES 120       // plant steps of 1 us
+
+/*
+ * Host time spent in the firmware's interrupt handlers while simulating.
+ */
+typedef struct SimInterruptCost {
+    uint32_t count;
+    double total_ns;
+    double max_ns;
+} SimInterruptCost;
+
+void SimInit(const MotorParameters *motor);
+void SimRun(double seconds);
+Plant *SimPlant();
+uint64_t SimCycles();
+double SimTime();
+uint32_t SimDroppedSamples();
+const SimInterruptCost *SimHallCost();
+const SimInterruptCost *SimAcquisitionCost();
+double SimNanoseconds();
+
+#endif /* HOST_SIM_PERIPHERALS_H_ */
@@ -0,0 +1,220 @@
+#include <math.h>
+#include <string.h>
+#include "plant.h"
+
+#define DIODE_DROP 0.7 // volts across a conducting body diode
+#define STOPPED 1e-6   // rad/s below which friction can hold the rotor
+
+/*
+ * Hall codes (H3 H2 H1) through the six sectors in the forward direction,
+ * matching the decode tables in speed.c. The sensors are mounted so sector s
+ * spans electrical angles 60s - 30 to 60s + 30 degrees, which centres the
+ * six-step drive of each sector on its torque peak: sector 0 drives C to B,
+ * and the torque of that pair goes as sin(a - 240) - sin(a - 120) = sqrt(3)cos(a).
+ */
+static const uint8_t HALL_CODES[6] = { 4, 5, 1, 3, 2, 6 };
+
+/*
+ * Wraps an angle into -pi to pi.
+ */
+static double Wrap(double angle) {
+    angle = fmod(angle + M_PI, 2 * M_PI);
+    if (angle < 0) {
+        angle += 2 * M_PI;
+    }
+    return angle - M_PI;
+}
+
+/*
+ * Unit back EMF of a phase at the given electrical angle. The trapezoid rises
+ * linearly over the 60 degrees around each zero crossing and is flat between.
+ */
+static double BackEmfShape(double angle, double trapezoid) {
+    double trapezium;
+
+    angle = Wrap(angle);
+    if (angle > M_PI / 2) {
+        trapezium = (M_PI - angle) / (M_PI / 6);
+    } else if (angle < -M_PI / 2) {
+        trapezium = (-M_PI - angle) / (M_PI / 6);
+    } else {
+        trapezium = angle / (M_PI / 6);
+    }
+    if (trapezium > 1) {
+        trapezium = 1;
+    } else if (trapezium < -1) {
+        trapezium = -1;
+    }
+    return (1 - trapezoid) * sin(angle) + trapezoid * trapezium;
+}
+
+void PlantInit(Plant *plant, const MotorParameters *motor) {
+    memset(plant, 0, sizeof(*plant));
+    plant->motor = *motor;
+}
+
+void PlantResetTotals(Plant *plant) {
+    plant->electrical_energy = 0;
+    plant->shaft_energy = 0;
+    plant->copper_energy = 0;
+    plant->torque_sum = 0;
+    plant->torque_square_sum = 0;
+    plant->torque_min = plant->torque;
+    plant->torque_max = plant->torque;
+    plant->total_time = 0;
+}
+
+double PlantElectricalAngle(const Plant *plant) {
+    return plant->angle * plant->motor.pole_pairs;
+}
+
+/*
+ * Speed in electrical revolutions per minute. speed.c counts one full cycle
+ * of the hall codes as a revolution, so this is the unit its RPM is in.
+ */
+double PlantSpeedRpm(const Plant *plant) {
+    return plant->speed * plant->motor.pole_pairs * 60 / (2 * M_PI);
+}
+
+uint8_t PlantHallCode(const Plant *plant) {
+    double angle = fmod(PlantElectricalAngle(plant) + M_PI / 6, 2 * M_PI);
+
+    if (angle < 0) {
+        angle += 2 * M_PI;
+    }
+    return HALL_CODES[(int)(angle / (M_PI / 3)) % 6];
+}
+
+/*
+ * Instantaneous current drawn from the bus at a point in the PWM period. A
+ * half bridge is switched high while carrier (0 to 1) is below its duty, so
+ * for edge aligned PWM carrier is the fraction of the period gone, and for
+ * centre aligned PWM it is the distance from the centre over half the period.
+ * Phases held in reset only return current to the bus through their upper
+ * diode.
+ */
+double PlantBusCurrent(const Plant *plant, double carrier) {
+    double current = 0;
+    int i;
+
+    for (i = 0; i < PLANT_PHASES; i++) {
+        if (plant->enabled[i]) {
+            if (carrier < plant->duty[i]) {
+                current += plant->current[i];
+            }
+        } else if (plant->current[i] < 0) {
+            current += plant->current[i];
+        }
+    }
+    return current;
+}
+
+/*
+ * Moves the motor on by dt seconds with forward Euler, dt has to be well
+ * under the electrical time constant. The inverter is averaged over the PWM
+ * period: an enabled half bridge holds its phase at duty times the bus
+ * voltage. A half bridge in reset leaves its phase floating until the back
+ * EMF or a decaying current forward biases one of its diodes. A floating
+ * phase is assumed to stay inside the rails, which holds while the back EMF
+ * is small next to the bus voltage.
+ */
+void PlantStep(Plant *plant, double dt) {
+    const MotorParameters *motor = &plant->motor;
+    double voltage[PLANT_PHASES], drive[PLANT_PHASES], neutral = 0, excess = 0, next;
+    double electrical = PlantElectricalAngle(plant), torque = 0, drag, acceleration, speed;
+    bool conducting[PLANT_PHASES];
+    int i, count = 0, free_count = 0;
+
+    for (i = 0; i < PLANT_PHASES; i++) {
+        plant->back_emf[i] = motor->back_emf * plant->speed *
+                             BackEmfShape(electrical - i * 2 * M_PI / 3, motor->trapezoid);
+        conducting[i] = true;
+        if (plant->enabled[i]) {
+            voltage[i] = plant->duty[i] * motor->bus_voltage;
+        } else if (plant->current[i] > 0) {
+            voltage[i] = -DIODE_DROP;
+        } else if (plant->current[i] < 0) {
+            voltage[i] = motor->bus_voltage + DIODE_DROP;
+        } else {
+            conducting[i] = false;
+        }
+        if (conducting[i]) {
+            drive[i] = voltage[i] - motor->resistance * plant->current[i] - plant->back_emf[i];
+            neutral += drive[i];
+            count++;
+        }
+    }
+
+    if (count < 2) {
+        for (i = 0; i < PLANT_PHASES; i++) {
+            plant->current[i] = 0;
+        }
+    } else {
+        // the star point sits where the phase currents keep summing to zero
+        neutral /= count;
+        for (i = 0; i < PLANT_PHASES; i++) {
+            if (!conducting[i]) {
+                continue;
+            }
+            next = plant->current[i] + (drive[i] - neutral) * dt / motor->inductance;
+
+            // a diode stops conducting when its current reaches zero
+            if (!plant->enabled[i] && next * plant->current[i] <= 0) {
+                excess += next;
+                next = 0;
+            } else {
+                free_count++;
+            }
+            plant->current[i] = next;
+        }
+        for (i = 0; i < PLANT_PHASES; i++) {
+            if (conducting[i] && plant->current[i] != 0 && free_count > 0) {
+                plant->current[i] += excess / free_count;
+            }
+        }
+    }
+
+    plant->bus_current = 0;
+    for (i = 0; i < PLANT_PHASES; i++) {
+        torque += motor->back_emf * BackEmfShape(electrical - i * 2 * M_PI / 3, motor->trapezoid) *
+                  plant->current[i];
+        if (plant->enabled[i]) {
+            plant->bus_current += plant->duty[i] * plant->current[i];
+        } else if (plant->current[i] < 0) {
+            plant->bus_current += plant->current[i];
+        }
+        plant->copper_energy += motor->resistance * plant->current[i] * plant->current[i] * dt;
+    }
+    plant->torque = torque;
+    plant->electrical_energy += motor->bus_voltage * plant->bus_current * dt;
+    plant->shaft_energy += torque * plant->speed * dt;
+    plant->torque_sum += torque * dt;
+    plant->torque_square_sum += torque * torque * dt;
+    if (torque < plant->torque_min) {
+        plant->torque_min = torque;
+    }
+    if (torque > plant->torque_max) {
+        plant->torque_max = torque;
+    }
+    plant->total_time += dt;
+
+    // friction and the load hold a stopped rotor until the torque overcomes them
+    drag = motor->coulomb + plant->load;
+    speed = plant->speed;
+    if (fabs(speed) < STOPPED) {
+        if (fabs(torque) <= drag) {
+            acceleration = 0;
+            speed = 0;
+        } else {
+            acceleration = (torque - (torque > 0 ? drag : -drag)) / motor->inertia;
+        }
+    } else {
+        acceleration = (torque - motor->viscous * speed - (speed > 0 ? drag : -drag)) / motor->inertia;
+    }
+    plant->speed = speed + acceleration * dt;
+    if (speed != 0 && plant->speed * speed < 0) {
+        plant->speed = 0;
+    }
+    plant->angle += plant->speed * dt;
+    plant->time += dt;
+}
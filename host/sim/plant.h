@@ -0,0 +1,71 @@
+#ifndef HOST_SIM_PLANT_H_
+#define HOST_SIM_PLANT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PLANT_PHASES 3
+
+/*
+ * Electrical and mechanical constants of a star wound three phase BLDC motor.
+ * The back EMF constant is the peak phase voltage per mechanical rad/s, and
+ * trapezoid blends the back EMF shape from a sine (0) to a flat topped
+ * trapezoid with 120 degree plateaus (1).
+ */
+typedef struct MotorParameters {
+    double resistance;  // ohms per phase
+    double inductance;  // henries per phase
+    double back_emf;    // volts per mechanical rad/s, phase peak
+    double trapezoid;   // back EMF shape, 0 sine to 1 trapezoid
+    int pole_pairs;
+    double inertia;     // kg m^2, rotor and load
+    double viscous;     // Nm per rad/s
+    double coulomb;     // Nm of friction while turning
+    double bus_voltage; // volts
+} MotorParameters;
+
+/*
+ * State of the motor and the inverter driving it. The inverter inputs are the
+ * averaged high side duty of each half bridge and whether its reset line lets
+ * it switch at all; a half bridge held in reset leaves its phase to the body
+ * diodes.
+ */
+typedef struct Plant {
+    MotorParameters motor;
+
+    // inverter inputs
+    double duty[PLANT_PHASES];
+    bool enabled[PLANT_PHASES];
+    double load;        // Nm against the direction of rotation
+
+    // state
+    double current[PLANT_PHASES];
+    double speed;       // mechanical rad/s
+    double angle;       // mechanical radians, unwrapped
+    double time;        // seconds
+
+    // outputs of the last step
+    double torque;      // electromagnetic, Nm
+    double bus_current; // averaged over the PWM period, amps
+    double back_emf[PLANT_PHASES];
+
+    // totals since the last PlantResetTotals()
+    double electrical_energy; // joules drawn from the bus
+    double shaft_energy;      // joules of electromagnetic work
+    double copper_energy;     // joules lost in the windings
+    double torque_sum;        // Nm s, and Nm^2 s for the square
+    double torque_square_sum;
+    double torque_min;
+    double torque_max;
+    double total_time;
+} Plant;
+
+void PlantInit(Plant *plant, const MotorParameters *motor);
+void PlantStep(Plant *plant, double dt);
+void PlantResetTotals(Plant *plant);
+double PlantElectricalAngle(const Plant *plant);
+double PlantSpeedRpm(const Plant *plant);
+uint8_t PlantHallCode(const Plant *plant);
+double PlantBusCurrent(const Plant *plant, double carrier);
+
+#endif /* HOST_SIM_PLANT_H_ */
@@ -0,0 +1,339 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "motor/acquisition.h"
+#include "motor/benchmark.h"
+#include "motor/measurement.h"
+#include "motor/speed.h"
+#include "motor/step_response.h"
+#include "state.h"
+#include "peripherals.h"
+
+/*
+ * Runs the speed control path of the firmware (speed.c, measurement.c,
+ * acquisition.c and the modules under them, with state.c on top) against a
+ * simulated motor, and scores it on scripted set point scenarios:
+ *
+ *   sim steps       set point and load steps, scored on the true rotor speed
+ *   sim benchmark   the firmware's own benchmark (benchmark.c), as on target
+ *   sim ripple      torque ripple and efficiency at steady operating points,
+ *                   for comparing six-step with SINUSOIDAL_DRIVE builds
+ *
+ * Speeds are in the firmware's RPM, hall cycles per minute. Times are in 1 ms
+ * control ticks. Loop costs are host nanoseconds, for comparing changes
+ * against each other; target cycle counts come from timing.h on the board.
+ *
+ * The motor is a 24 V, 4 pole pair, 42 mm class BLDC with datasheet typical
+ * constants, not measured from the kit's motor. Any of them can be changed
+ * from the command line, as in "sim steps back_emf=0.1 inertia=2e-5".
+ */
+static MotorParameters motor = {
+    .resistance = 0.9,
+    .inductance = 1.3e-3,
+    .back_emf = 0.0215,
+    .trapezoid = 0.5,
+    .pole_pairs = 4,
+    .inertia = 4.8e-6,
+    .viscous = 2e-6,
+    .coulomb = 3e-3,
+    .bus_voltage = 24,
+};
+
+#define TICK 0.001 // seconds per control tick, the control group's rate
+#define TELEMETRY_TICKS 1000 // ticks between history samples, the thermal task's once a second
+
+typedef struct ScenarioStep {
+    int32_t speed;     // RPM
+    double load;       // Nm
+    uint32_t duration; // ticks
+} ScenarioStep;
+
+/*
+ * The benchmark's set points, then a load applied and removed at a steady speed.
+ */
+static const ScenarioStep STEPS[] = {
+    {300, 0, 4000},
+    {800, 0, 4000},
+    {500, 0, 4000},
+    {1000, 0, 5000},
+    {200, 0, 5000},
+    {600, 0, 3000},
+    {600, 0.02, 3000},
+    {600, 0, 3000},
+};
+#define STEP_COUNT (sizeof(STEPS) / sizeof(STEPS[0]))
+
+/*
+ * Steady operating points for the ripple scenario, measured over the last
+ * second of each.
+ */
+static const ScenarioStep OPERATING_POINTS[] = {
+    {300, 0.02, 3000},
+    {600, 0.02, 3000},
+    {1000, 0.02, 3000},
+    {600, 0.05, 3000},
+};
+#define OPERATING_POINT_COUNT (sizeof(OPERATING_POINTS) / sizeof(OPERATING_POINTS[0]))
+
+#ifdef SINUSOIDAL_DRIVE
+#define DRIVE "sinusoidal"
+#else
+#define DRIVE "six-step"
+#endif
+
+typedef struct Parameter {
+    const char *name;
+    size_t offset;
+} Parameter;
+
+static const Parameter PARAMETERS[] = {
+    { "resistance", offsetof(MotorParameters, resistance) },
+    { "inductance", offsetof(MotorParameters, inductance) },
+    { "back_emf", offsetof(MotorParameters, back_emf) },
+    { "trapezoid", offsetof(MotorParameters, trapezoid) },
+    { "inertia", offsetof(MotorParameters, inertia) },
+    { "viscous", offsetof(MotorParameters, viscous) },
+    { "coulomb", offsetof(MotorParameters, coulomb) },
+    { "bus_voltage", offsetof(MotorParameters, bus_voltage) },
+};
+#define PARAMETER_COUNT (sizeof(PARAMETERS) / sizeof(PARAMETERS[0]))
+
+static uint32_t ticks = 0;
+static double tick_ns = 0, max_tick_ns = 0;
+
+/*
+ * Brings the firmware up the way main.c and schedule.c do, less the
+ * temperature sensor and the UI.
+ */
+static void Boot() {
+    StartADCSampling();
+    ConnectWithMotor();
+    MeasurementInit();
+    if (ConnectWithHallSensors() < 0) {
+        printf("hall sensors read as faulty at start up\n");
+    }
+    SetMotorCurrentLimit(get_current_limit() / 1000.0f, 0);
+}
+
+static void StartRunning(int32_t speed) {
+    set_motor_power(ON);
+    set_motor_speed(speed);
+    StartMotor();
+}
+
+/*
+ * One control group tick, then the motor runs on until the next.
+ */
+static void Tick() {
+    double start = SimNanoseconds(), elapsed, current;
+
+    RotateMotor();
+    TakeMeasurements();
+    elapsed = SimNanoseconds() - start;
+    tick_ns += elapsed;
+    if (elapsed > max_tick_ns) {
+        max_tick_ns = elapsed;
+    }
+
+    // the once a second telemetry of thermalTask in schedule.c
+    if (++ticks % TELEMETRY_TICKS == 0) {
+        current = GetFilteredCurrentValue() * 1000;
+        appendToMotorSpeed(GetFilteredSpeed());
+        appendToCurrent(current > 0 ? (uint32_t)current : 0);
+    }
+    SimRun(TICK);
+}
+
+/*
+ * Applies a name=value setting to the motor. Returns false if it isn't one.
+ */
+static bool SetParameter(const char *setting) {
+    const char *value = strchr(setting, '=');
+    size_t length;
+    unsigned i;
+
+    if (!value) {
+        return false;
+    }
+    length = value - setting;
+    if (length == strlen("pole_pairs") && strncmp(setting, "pole_pairs", length) == 0) {
+        motor.pole_pairs = atoi(value + 1);
+        return motor.pole_pairs > 0;
+    }
+    for (i = 0; i < PARAMETER_COUNT; i++) {
+        if (length == strlen(PARAMETERS[i].name) && strncmp(setting, PARAMETERS[i].name, length) == 0) {
+            *(double *)((char *)&motor + PARAMETERS[i].offset) = atof(value + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void PrintCosts() {
+    const SimInterruptCost *hall = SimHallCost(), *acquisition = SimAcquisitionCost();
+
+    printf("loop cost (host): control tick %.0f ns mean %.0f ns max over %u ticks\n",
+           ticks ? tick_ns / ticks : 0, max_tick_ns, ticks);
+    printf("                  hall edge %.0f ns mean %.0f ns max over %u edges\n",
+           hall->count ? hall->total_ns / hall->count : 0, hall->max_ns, hall->count);
+    printf("                  ADC block %.0f ns mean %.0f ns max over %u blocks (%u samples dropped)\n",
+           acquisition->count ? acquisition->total_ns / acquisition->count : 0, acquisition->max_ns,
+           acquisition->count, SimDroppedSamples());
+}
+
+/*
+ * Steps through STEPS, scoring each step on the rotor's true speed, sampled
+ * once a tick. Over the last second of each step the true speed's swing is
+ * recorded, and the measured speed and current are compared with the plant's.
+ * The current is the phase current the sensor carries during the on pulse,
+ * which is what the firmware samples.
+ */
+static int RunSteps() {
+    Plant *plant = SimPlant();
+    StepResponse response;
+    int32_t previous = 0;
+    unsigned i;
+    uint32_t n;
+
+    printf("step            rise  settle  overshoot  error  |  swing  speed true  measured  current true  measured\n");
+    StartRunning(STEPS[0].speed);
+    for (i = 0; i < STEP_COUNT; i++) {
+        const ScenarioStep *step = &STEPS[i];
+        double true_speed = 0, measured_speed = 0, true_current = 0, measured_current = 0;
+        double speed, lowest = 1e9, highest = -1e9;
+        uint32_t window = step->duration < 1000 ? step->duration : 1000;
+
+        set_motor_speed(step->speed);
+        plant->load = step->load;
+        StepResponseStart(&response, previous, step->speed);
+        for (n = 0; n < step->duration; n++) {
+            Tick();
+            speed = PlantSpeedRpm(plant);
+            StepResponseUpdate(&response, (int32_t)lround(speed));
+            if (n >= step->duration - window) {
+                lowest = speed < lowest ? speed : lowest;
+                highest = speed > highest ? speed : highest;
+                true_speed += speed;
+                measured_speed += GetFilteredSpeed();
+                true_current += PlantBusCurrent(plant, 0);
+                measured_current += GetFilteredCurrentValue();
+            }
+        }
+
+        if (step->speed != previous) {
+            printf("%4d to %4d RPM %5u ", (int)previous, (int)step->speed, StepResponseRiseTime(&response));
+            if (StepResponseHasSettled(&response)) {
+                printf("%6u %8d%% %6d", StepResponseSettlingTime(&response),
+                       (int)StepResponseOvershoot(&response), (int)StepResponseSteadyStateError(&response));
+            } else {
+                printf("     - %8d%%      -", (int)StepResponseOvershoot(&response));
+            }
+        } else {
+            printf("%4d RPM, load %s %2.0f mNm         ", (int)step->speed, step->load > 0 ? "on " : "off",
+                   step->load * 1000);
+        }
+        printf("  | %6.0f %11.1f %9.1f %11.3f A %7.3f A\n", highest - lowest, true_speed / window,
+               measured_speed / window, true_current / window, measured_current / window);
+        previous = step->speed;
+    }
+
+    printf("telemetry: largest speed %u RPM, smallest %u RPM, largest current %u mA\n",
+           get_largest_motor_speed(), get_smallest_motor_speed(), get_largest_current());
+    printf("faulty motor: %s, commutations: %u\n", IsMotorFaulty() ? "yes" : "no", GetCommutationCount());
+    PrintCosts();
+    return IsMotorFaulty();
+}
+
+/*
+ * Starts the firmware's benchmark once the motor is turning, and lets it
+ * print its own report at the end.
+ */
+static int RunBenchmark() {
+    uint32_t n;
+
+    StartRunning(500);
+    for (n = 0; n < 2000; n++) {
+        Tick();
+    }
+    if (!StartSpeedBenchmark()) {
+        printf("the benchmark would not start\n");
+        return 1;
+    }
+    for (n = 0; n < 60000 && !BenchmarkIsDone(); n++) {
+        Tick();
+    }
+    if (!BenchmarkIsDone()) {
+        printf("the benchmark did not finish\n");
+        return 1;
+    }
+    printf("(cycle counts read 0: firmware code takes no simulated time)\n");
+    PrintCosts();
+    return 0;
+}
+
+/*
+ * Holds each operating point and reports the electromagnetic torque's ripple,
+ * peak to peak and RMS as a percentage of its mean, the RMS phase current and
+ * how much of the power drawn from the bus reaches the rotor. Only winding
+ * and diode losses are modelled, so the efficiency compares the drives
+ * rather than predicting the motor's.
+ */
+static int RunRipple() {
+    Plant *plant = SimPlant();
+    double mean, rms, phase_current, power;
+    unsigned i;
+    uint32_t n;
+
+    printf("%s drive, back EMF %.0f%% trapezoid\n", DRIVE, motor.trapezoid * 100);
+    printf("speed  load    torque  ripple p-p   rms  |  phase current  power  efficiency\n");
+    StartRunning(OPERATING_POINTS[0].speed);
+    for (i = 0; i < OPERATING_POINT_COUNT; i++) {
+        const ScenarioStep *point = &OPERATING_POINTS[i];
+
+        set_motor_speed(point->speed);
+        plant->load = point->load;
+        for (n = 0; n < point->duration; n++) {
+            if (n == point->duration - 1000) {
+                PlantResetTotals(plant);
+            }
+            Tick();
+        }
+
+        mean = plant->torque_sum / plant->total_time;
+        rms = sqrt(plant->torque_square_sum / plant->total_time - mean * mean);
+        phase_current = sqrt(plant->copper_energy / (motor.resistance * plant->total_time * PLANT_PHASES));
+        power = plant->electrical_energy / plant->total_time;
+        printf("%5d %3.0f mNm %5.1f mNm %9.0f%% %4.0f%%  |  %11.3f A %5.2f W %9.1f%%\n",
+               (int)point->speed, point->load * 1000, mean * 1000,
+               (plant->torque_max - plant->torque_min) / mean * 100, rms / mean * 100,
+               phase_current, power, plant->shaft_energy / plant->electrical_energy * 100);
+    }
+    return IsMotorFaulty();
+}
+
+int main(int argc, char **argv) {
+    const char *scenario = argc > 1 ? argv[1] : "steps";
+    int i;
+
+    for (i = 2; i < argc; i++) {
+        if (!SetParameter(argv[i])) {
+            printf("unknown motor parameter %s\n", argv[i]);
+            return 1;
+        }
+    }
+    SimInit(&motor);
+    Boot();
+    if (strcmp(scenario, "steps") == 0) {
+        return RunSteps();
+    } else if (strcmp(scenario, "benchmark") == 0) {
+        return RunBenchmark();
+    } else if (strcmp(scenario, "ripple") == 0) {
+        return RunRipple();
+    }
+    printf("usage: %s [steps | benchmark | ripple] [name=value ...]\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,21 @@
+#ifndef HOST_ADC_H_
+#define HOST_ADC_H_
+
+#include <stdint.h>
+
+#define ADC_TRIGGER_PWM0 0x00000006
+#define ADC_TRIGGER_PWM_MOD0 0x00000000
+#define ADC_CTL_CH0 0x00000000
+#define ADC_CTL_CH1 0x00000001
+#define ADC_CTL_IE 0x00000040
+#define ADC_CTL_END 0x00000020
+#define ADC_INT_DMA_SS0 0x00000100
+
+void ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum, uint32_t ui32Trigger, uint32_t ui32Priority);
+void ADCSequenceStepConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum, uint32_t ui32Step, uint32_t ui32Config);
+void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+void ADCSequenceDMAEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+void ADCIntClearEx(uint32_t ui32Base, uint32_t ui32IntFlags);
+void ADCIntEnableEx(uint32_t ui32Base, uint32_t ui32IntFlags);
+
+#endif /* HOST_ADC_H_ */
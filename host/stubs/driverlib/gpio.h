@@ -0,0 +1,44 @@
+#ifndef HOST_GPIO_H_
+#define HOST_GPIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GPIO_PIN_0 0x01
+#define GPIO_PIN_1 0x02
+#define GPIO_PIN_2 0x04
+#define GPIO_PIN_3 0x08
+#define GPIO_PIN_4 0x10
+#define GPIO_PIN_5 0x20
+#define GPIO_PIN_6 0x40
+#define GPIO_PIN_7 0x80
+
+#define GPIO_INT_PIN_0 0x01
+#define GPIO_INT_PIN_1 0x02
+#define GPIO_INT_PIN_2 0x04
+#define GPIO_INT_PIN_3 0x08
+#define GPIO_INT_PIN_4 0x10
+#define GPIO_INT_PIN_5 0x20
+#define GPIO_INT_PIN_6 0x40
+#define GPIO_INT_PIN_7 0x80
+
+#define GPIO_BOTH_EDGES 0x01
+
+void GPIOPinConfigure(uint32_t ui32PinConfig);
+void GPIOPinTypeADC(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeI2C(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeI2CSCL(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypePWM(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeTimer(uint32_t ui32Port, uint8_t ui8Pins);
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val);
+void GPIOIntRegister(uint32_t ui32Port, void (*pfnIntHandler)(void));
+void GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType);
+void GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags);
+void GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags);
+uint32_t GPIOIntStatus(uint32_t ui32Port, bool bMasked);
+void GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags);
+
+#endif /* HOST_GPIO_H_ */
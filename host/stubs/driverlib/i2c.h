@@ -0,0 +1,27 @@
+#ifndef HOST_I2C_H_
+#define HOST_I2C_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define I2C_MASTER_CMD_BURST_SEND_START 0x00000003
+#define I2C_MASTER_CMD_BURST_SEND_CONT 0x00000001
+#define I2C_MASTER_CMD_BURST_SEND_FINISH 0x00000005
+#define I2C_MASTER_CMD_BURST_SEND_ERROR_STOP 0x00000004
+#define I2C_MASTER_CMD_BURST_RECEIVE_START 0x0000000b
+#define I2C_MASTER_CMD_BURST_RECEIVE_CONT 0x00000009
+#define I2C_MASTER_CMD_BURST_RECEIVE_FINISH 0x00000005
+#define I2C_MASTER_CMD_BURST_RECEIVE_ERROR_STOP 0x00000004
+#define I2C_MASTER_ERR_NONE 0
+
+void I2CMasterInitExpClk(uint32_t ui32Base, uint32_t ui32I2CClk, bool bFast);
+void I2CMasterIntEnable(uint32_t ui32Base);
+bool I2CMasterIntStatus(uint32_t ui32Base, bool bMasked);
+void I2CMasterIntClear(uint32_t ui32Base);
+void I2CMasterSlaveAddrSet(uint32_t ui32Base, uint8_t ui8SlaveAddr, bool bReceive);
+void I2CMasterControl(uint32_t ui32Base, uint32_t ui32Cmd);
+void I2CMasterDataPut(uint32_t ui32Base, uint8_t ui8Data);
+uint32_t I2CMasterDataGet(uint32_t ui32Base);
+uint32_t I2CMasterErr(uint32_t ui32Base);
+
+#endif /* HOST_I2C_H_ */
@@ -0,0 +1,16 @@
+#ifndef HOST_PIN_MAP_H_
+#define HOST_PIN_MAP_H_
+
+#define GPIO_PA7_T3CCP1 0x00001c03
+#define GPIO_PF2_M0PWM2 0x00050806
+#define GPIO_PG0_M0PWM4 0x00060006
+#define GPIO_PK4_M0PWM6 0x00091006
+#define GPIO_PL0_I2C2SDA 0x000a0002
+#define GPIO_PL1_I2C2SCL 0x000a0402
+#define GPIO_PL4_T0CCP0 0x000a1003
+#define GPIO_PL5_T0CCP1 0x000a1403
+#define GPIO_PM0_T2CCP0 0x000b0003
+#define GPIO_PM1_T2CCP1 0x000b0403
+#define GPIO_PM2_T3CCP0 0x000b0803
+
+#endif /* HOST_PIN_MAP_H_ */
@@ -0,0 +1,43 @@
+#ifndef HOST_PWM_H_
+#define HOST_PWM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PWM_GEN_0 0x00000040
+#define PWM_GEN_1 0x00000080
+#define PWM_GEN_2 0x000000c0
+#define PWM_GEN_3 0x00000100
+#define PWM_GEN_0_BIT 0x00000001
+#define PWM_GEN_1_BIT 0x00000002
+#define PWM_GEN_2_BIT 0x00000004
+#define PWM_GEN_3_BIT 0x00000008
+#define PWM_OUT_0 0x00000040
+#define PWM_OUT_2 0x000000c2
+#define PWM_OUT_4 0x00000104
+#define PWM_OUT_6 0x00000146
+#define PWM_OUT_2_BIT 0x00000004
+#define PWM_OUT_4_BIT 0x00000010
+#define PWM_OUT_6_BIT 0x00000040
+#define PWM_GEN_MODE_DOWN 0x00000000
+#define PWM_GEN_MODE_UP_DOWN 0x00000002
+#define PWM_GEN_MODE_SYNC 0x00000038
+#define PWM_GEN_MODE_NO_SYNC 0x00000000
+#define PWM_OUTPUT_MODE_SYNC_GLOBAL 0x00000003
+#define PWM_SYSCLK_DIV_1 0x00000000
+#define PWM_SYSCLK_DIV_8 0x00000102
+#define PWM_TR_CNT_ZERO 0x00000100
+#define PWM_TR_CMP_AD 0x00000800
+
+void PWMClockSet(uint32_t ui32Base, uint32_t ui32Config);
+void PWMGenConfigure(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Config);
+void PWMGenPeriodSet(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Period);
+void PWMGenEnable(uint32_t ui32Base, uint32_t ui32Gen);
+void PWMGenIntTrigEnable(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32IntTrig);
+void PWMPulseWidthSet(uint32_t ui32Base, uint32_t ui32PWMOut, uint32_t ui32Width);
+void PWMOutputState(uint32_t ui32Base, uint32_t ui32PWMOutBits, bool bEnable);
+void PWMOutputUpdateMode(uint32_t ui32Base, uint32_t ui32PWMOutBits, uint32_t ui32Mode);
+void PWMSyncTimeBase(uint32_t ui32Base, uint32_t ui32GenBits);
+void PWMSyncUpdate(uint32_t ui32Base, uint32_t ui32GenBits);
+
+#endif /* HOST_PWM_H_ */
@@ -0,0 +1,8 @@
+#ifndef HOST_SW_CRC_H_
+#define HOST_SW_CRC_H_
+
+#include <stdint.h>
+
+uint32_t Crc32(uint32_t ui32Crc, const uint8_t *pui8Data, uint32_t ui32Count);
+
+#endif /* HOST_SW_CRC_H_ */
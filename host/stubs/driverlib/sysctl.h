@@ -0,0 +1,27 @@
+#ifndef HOST_SYSCTL_H_
+#define HOST_SYSCTL_H_
+
+#include <stdint.h>
+
+#define SYSCTL_PERIPH_ADC0 0xf0003800
+#define SYSCTL_PERIPH_ADC1 0xf0003801
+#define SYSCTL_PERIPH_GPIOA 0xf0000800
+#define SYSCTL_PERIPH_GPIOC 0xf0000802
+#define SYSCTL_PERIPH_GPIOE 0xf0000804
+#define SYSCTL_PERIPH_GPIOF 0xf0000805
+#define SYSCTL_PERIPH_GPIOG 0xf0000806
+#define SYSCTL_PERIPH_GPIOK 0xf0000809
+#define SYSCTL_PERIPH_GPIOL 0xf000080a
+#define SYSCTL_PERIPH_GPIOM 0xf000080b
+#define SYSCTL_PERIPH_GPIOP 0xf000080d
+#define SYSCTL_PERIPH_I2C2 0xf0002002
+#define SYSCTL_PERIPH_PWM0 0xf0004000
+#define SYSCTL_PERIPH_TIMER0 0xf0000400
+#define SYSCTL_PERIPH_TIMER2 0xf0000402
+#define SYSCTL_PERIPH_TIMER3 0xf0000403
+#define SYSCTL_PERIPH_UDMA 0xf0000c00
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+void SysCtlDelay(uint32_t ui32Count);
+
+#endif /* HOST_SYSCTL_H_ */
@@ -0,0 +1,30 @@
+#ifndef HOST_TIMER_H_
+#define HOST_TIMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMER_A 0x000000ff
+#define TIMER_B 0x0000ff00
+#define TIMER_BOTH 0x0000ffff
+
+#define TIMER_CFG_SPLIT_PAIR 0x04000000
+#define TIMER_CFG_A_PWM 0x0000000a
+#define TIMER_CFG_B_PWM 0x00000a00
+
+#define TIMER_0A_SYNC 0x00000001
+#define TIMER_0B_SYNC 0x00000002
+#define TIMER_2A_SYNC 0x00000010
+#define TIMER_2B_SYNC 0x00000020
+#define TIMER_3A_SYNC 0x00000040
+#define TIMER_3B_SYNC 0x00000080
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config);
+void TimerControlLevel(uint32_t ui32Base, uint32_t ui32Timer, bool bInvert);
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer);
+void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer);
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value);
+void TimerMatchSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value);
+void TimerSynchronize(uint32_t ui32Base, uint32_t ui32Timers);
+
+#endif /* HOST_TIMER_H_ */
@@ -0,0 +1,38 @@
+#ifndef HOST_UDMA_H_
+#define HOST_UDMA_H_
+
+#include <stdint.h>
+
+typedef struct {
+    volatile void *pvSrcEndAddr;
+    volatile void *pvDstEndAddr;
+    volatile uint32_t ui32Control;
+    volatile uint32_t ui32Spare;
+} tDMAControlTable;
+
+#define UDMA_SEC_CHANNEL_ADC10 24
+#define UDMA_CH24_ADC1_0 0x00010018
+#define UDMA_PRI_SELECT 0x00000000
+#define UDMA_ALT_SELECT 0x00000020
+#define UDMA_ATTR_USEBURST 0x00000001
+#define UDMA_ATTR_ALTSELECT 0x00000002
+#define UDMA_ATTR_HIGH_PRIORITY 0x00000004
+#define UDMA_ATTR_REQMASK 0x00000008
+#define UDMA_SIZE_16 0x11000000
+#define UDMA_SRC_INC_NONE 0x0c000000
+#define UDMA_DST_INC_16 0x40000000
+#define UDMA_ARB_1 0x00000000
+#define UDMA_MODE_STOP 0x00000000
+#define UDMA_MODE_PINGPONG 0x00000003
+
+void uDMAEnable(void);
+void uDMAControlBaseSet(void *pControlTable);
+void uDMAChannelAssign(uint32_t ui32Mapping);
+void uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr);
+void uDMAChannelControlSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Control);
+void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Mode,
+                            void *pvSrcAddr, void *pvDstAddr, uint32_t ui32TransferSize);
+void uDMAChannelEnable(uint32_t ui32ChannelNum);
+uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex);
+
+#endif /* HOST_UDMA_H_ */
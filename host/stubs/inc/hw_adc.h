@@ -0,0 +1,6 @@
+#ifndef HOST_HW_ADC_H_
+#define HOST_HW_ADC_H_
+
+#define ADC_O_SSFIFO0 0x00000048
+
+#endif /* HOST_HW_ADC_H_ */
@@ -0,0 +1,25 @@
+#ifndef HOST_HW_MEMMAP_H_
+#define HOST_HW_MEMMAP_H_
+
+/*
+ * Host stand-in for the TivaWare peripheral base addresses. The values match
+ * the TM4C129 memory map but are only ever compared, never dereferenced.
+ */
+#define GPIO_PORTA_BASE 0x40058000
+#define GPIO_PORTC_BASE 0x4005A000
+#define GPIO_PORTE_BASE 0x4005C000
+#define GPIO_PORTF_BASE 0x4005D000
+#define GPIO_PORTG_BASE 0x4005E000
+#define GPIO_PORTK_BASE 0x40061000
+#define GPIO_PORTL_BASE 0x40062000
+#define GPIO_PORTM_BASE 0x40063000
+#define GPIO_PORTP_BASE 0x40065000
+#define TIMER0_BASE 0x40030000
+#define TIMER2_BASE 0x40032000
+#define TIMER3_BASE 0x40033000
+#define ADC0_BASE 0x40038000
+#define ADC1_BASE 0x40039000
+#define PWM0_BASE 0x40028000
+#define I2C2_BASE 0x40022000
+
+#endif /* HOST_HW_MEMMAP_H_ */
@@ -0,0 +1,7 @@
+#ifndef HOST_HW_TYPES_H_
+#define HOST_HW_TYPES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#endif /* HOST_HW_TYPES_H_ */
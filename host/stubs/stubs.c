@@ -0,0 +1,116 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/timer.h>
+#include <driverlib/pwm.h>
+#include <driverlib/adc.h>
+#include <driverlib/udma.h>
+#include <driverlib/i2c.h>
+#include <driverlib/sw_crc.h>
+#include "utils/flash_pb.h"
+#include "motor/timing.h"
+
+/*
+ * Do nothing versions of the driverlib, SYS/BIOS and timing calls the
+ * firmware modules make, so they link on the host. They are weak, so a
+ * simulation supplies its own for whatever it models (see sim/peripherals.c).
+ * The I2C bus never answers, so sensor reads fail cleanly.
+ */
+#define WEAK __attribute__((weak))
+
+WEAK void SysCtlPeripheralEnable(uint32_t ui32Peripheral) {}
+WEAK void SysCtlDelay(uint32_t ui32Count) {}
+
+WEAK void GPIOPinConfigure(uint32_t ui32PinConfig) {}
+WEAK void GPIOPinTypeADC(uint32_t ui32Port, uint8_t ui8Pins) {}
+WEAK void GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins) {}
+WEAK void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins) {}
+WEAK void GPIOPinTypeI2C(uint32_t ui32Port, uint8_t ui8Pins) {}
+WEAK void GPIOPinTypeI2CSCL(uint32_t ui32Port, uint8_t ui8Pins) {}
+WEAK void GPIOPinTypePWM(uint32_t ui32Port, uint8_t ui8Pins) {}
+WEAK void GPIOPinTypeTimer(uint32_t ui32Port, uint8_t ui8Pins) {}
+WEAK int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins) { return 0; }
+WEAK void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val) {}
+WEAK void GPIOIntRegister(uint32_t ui32Port, void (*pfnIntHandler)(void)) {}
+WEAK void GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType) {}
+WEAK void GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags) {}
+WEAK void GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags) {}
+WEAK uint32_t GPIOIntStatus(uint32_t ui32Port, bool bMasked) { return 0; }
+WEAK void GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags) {}
+
+WEAK void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config) {}
+WEAK void TimerControlLevel(uint32_t ui32Base, uint32_t ui32Timer, bool bInvert) {}
+WEAK void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer) {}
+WEAK void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer) {}
+WEAK void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value) {}
+WEAK void TimerMatchSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value) {}
+WEAK void TimerSynchronize(uint32_t ui32Base, uint32_t ui32Timers) {}
+
+WEAK void PWMClockSet(uint32_t ui32Base, uint32_t ui32Config) {}
+WEAK void PWMGenConfigure(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Config) {}
+WEAK void PWMGenPeriodSet(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Period) {}
+WEAK void PWMGenEnable(uint32_t ui32Base, uint32_t ui32Gen) {}
+WEAK void PWMGenIntTrigEnable(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32IntTrig) {}
+WEAK void PWMPulseWidthSet(uint32_t ui32Base, uint32_t ui32PWMOut, uint32_t ui32Width) {}
+WEAK void PWMOutputState(uint32_t ui32Base, uint32_t ui32PWMOutBits, bool bEnable) {}
+WEAK void PWMOutputUpdateMode(uint32_t ui32Base, uint32_t ui32PWMOutBits, uint32_t ui32Mode) {}
+WEAK void PWMSyncTimeBase(uint32_t ui32Base, uint32_t ui32GenBits) {}
+WEAK void PWMSyncUpdate(uint32_t ui32Base, uint32_t ui32GenBits) {}
+
+WEAK void ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum, uint32_t ui32Trigger, uint32_t ui32Priority) {}
+WEAK void ADCSequenceStepConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum, uint32_t ui32Step, uint32_t ui32Config) {}
+WEAK void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum) {}
+WEAK void ADCSequenceDMAEnable(uint32_t ui32Base, uint32_t ui32SequenceNum) {}
+WEAK void ADCIntClearEx(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+WEAK void ADCIntEnableEx(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+
+WEAK void uDMAEnable(void) {}
+WEAK void uDMAControlBaseSet(void *pControlTable) {}
+WEAK void uDMAChannelAssign(uint32_t ui32Mapping) {}
+WEAK void uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr) {}
+WEAK void uDMAChannelControlSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Control) {}
+WEAK void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Mode,
+                                 void *pvSrcAddr, void *pvDstAddr, uint32_t ui32TransferSize) {}
+WEAK void uDMAChannelEnable(uint32_t ui32ChannelNum) {}
+WEAK uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex) { return UDMA_MODE_PINGPONG; }
+
+WEAK void I2CMasterInitExpClk(uint32_t ui32Base, uint32_t ui32I2CClk, bool bFast) {}
+WEAK void I2CMasterIntEnable(uint32_t ui32Base) {}
+WEAK bool I2CMasterIntStatus(uint32_t ui32Base, bool bMasked) { return false; }
+WEAK void I2CMasterIntClear(uint32_t ui32Base) {}
+WEAK void I2CMasterSlaveAddrSet(uint32_t ui32Base, uint8_t ui8SlaveAddr, bool bReceive) {}
+WEAK void I2CMasterControl(uint32_t ui32Base, uint32_t ui32Cmd) {}
+WEAK void I2CMasterDataPut(uint32_t ui32Base, uint8_t ui8Data) {}
+WEAK uint32_t I2CMasterDataGet(uint32_t ui32Base) { return 0; }
+WEAK uint32_t I2CMasterErr(uint32_t ui32Base) { return 1; }
+
+WEAK uint32_t Crc32(uint32_t ui32Crc, const uint8_t *pui8Data, uint32_t ui32Count) { return ui32Crc; }
+WEAK uint8_t *FlashPBGet(void) { return 0; }
+WEAK void FlashPBSave(uint8_t *pui8Buffer) {}
+WEAK void FlashPBInit(uint32_t ui32Start, uint32_t ui32End, uint32_t ui32Size) {}
+
+WEAK BIOS_ThreadType BIOS_getThreadType(void) { return BIOS_ThreadType_Task; }
+WEAK void BIOS_start(void) {}
+WEAK UInt Hwi_disable(void) { return 0; }
+WEAK void Hwi_restore(UInt key) {}
+WEAK UInt Task_disable(void) { return 0; }
+WEAK void Task_restore(UInt key) {}
+WEAK uint32_t Clock_getTicks(void) { return 0; }
+
+WEAK void Semaphore_Params_init(Semaphore_Params *params) { params->mode = Semaphore_Mode_COUNTING; }
+WEAK void Semaphore_construct(Semaphore_Struct *structP, Int count, const Semaphore_Params *params) { structP->count = count; }
+WEAK Semaphore_Handle Semaphore_handle(Semaphore_Struct *structP) { return structP; }
+WEAK Bool Semaphore_pend(Semaphore_Handle handle, UInt timeout) { return FALSE; }
+WEAK void Semaphore_post(Semaphore_Handle handle) { handle->count++; }
+WEAK void Semaphore_reset(Semaphore_Handle handle, Int count) { handle->count = count; }
+
+WEAK void TimingInit() {}
+WEAK uint32_t TimingNow() { return 0; }
+WEAK uint32_t TimingElapsed(uint32_t since) { return TimingNow() - since; }
@@ -0,0 +1,4 @@
+#ifndef HOST_TI_DRIVERS_I2C_H_
+#define HOST_TI_DRIVERS_I2C_H_
+
+#endif /* HOST_TI_DRIVERS_I2C_H_ */
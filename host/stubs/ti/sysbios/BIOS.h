@@ -0,0 +1,19 @@
+#ifndef HOST_BIOS_H_
+#define HOST_BIOS_H_
+
+#include <xdc/std.h>
+
+#define BIOS_WAIT_FOREVER (~(UInt)0)
+#define BIOS_NO_WAIT 0
+
+typedef enum BIOS_ThreadType {
+    BIOS_ThreadType_Hwi,
+    BIOS_ThreadType_Swi,
+    BIOS_ThreadType_Task,
+    BIOS_ThreadType_Main,
+} BIOS_ThreadType;
+
+BIOS_ThreadType BIOS_getThreadType(void);
+void BIOS_start(void);
+
+#endif /* HOST_BIOS_H_ */
@@ -0,0 +1,9 @@
+#ifndef HOST_HWI_H_
+#define HOST_HWI_H_
+
+#include <xdc/std.h>
+
+UInt Hwi_disable(void);
+void Hwi_restore(UInt key);
+
+#endif /* HOST_HWI_H_ */
@@ -0,0 +1,9 @@
+#ifndef HOST_CLOCK_H_
+#define HOST_CLOCK_H_
+
+#include <stdint.h>
+#include <xdc/std.h>
+
+uint32_t Clock_getTicks(void);
+
+#endif /* HOST_CLOCK_H_ */
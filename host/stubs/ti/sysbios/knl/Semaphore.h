@@ -0,0 +1,26 @@
+#ifndef HOST_SEMAPHORE_H_
+#define HOST_SEMAPHORE_H_
+
+#include <xdc/std.h>
+
+typedef enum Semaphore_Mode {
+    Semaphore_Mode_COUNTING,
+    Semaphore_Mode_BINARY,
+} Semaphore_Mode;
+
+typedef struct Semaphore_Params {
+    Semaphore_Mode mode;
+} Semaphore_Params;
+
+typedef struct Semaphore_Struct {
+    int count;
+} Semaphore_Struct, *Semaphore_Handle;
+
+void Semaphore_Params_init(Semaphore_Params *params);
+void Semaphore_construct(Semaphore_Struct *structP, Int count, const Semaphore_Params *params);
+Semaphore_Handle Semaphore_handle(Semaphore_Struct *structP);
+Bool Semaphore_pend(Semaphore_Handle handle, UInt timeout);
+void Semaphore_post(Semaphore_Handle handle);
+void Semaphore_reset(Semaphore_Handle handle, Int count);
+
+#endif /* HOST_SEMAPHORE_H_ */
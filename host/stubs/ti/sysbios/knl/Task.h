@@ -0,0 +1,9 @@
+#ifndef HOST_TASK_H_
+#define HOST_TASK_H_
+
+#include <xdc/std.h>
+
+UInt Task_disable(void);
+void Task_restore(UInt key);
+
+#endif /* HOST_TASK_H_ */
@@ -0,0 +1,9 @@
+#ifndef HOST_XDC_SYSTEM_H_
+#define HOST_XDC_SYSTEM_H_
+
+#include <stdio.h>
+
+// SysMin output goes straight to stdout on the host
+#define System_printf printf
+
+#endif /* HOST_XDC_SYSTEM_H_ */
@@ -0,0 +1,16 @@
+#ifndef HOST_XDC_STD_H_
+#define HOST_XDC_STD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef int Int;
+typedef unsigned int UInt;
+typedef uintptr_t UArg;
+typedef int Bool;
+#define Void void
+
+#define TRUE 1
+#define FALSE 0
+
+#endif /* HOST_XDC_STD_H_ */
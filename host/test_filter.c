@@ -0,0 +1,232 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "motor/filter.h"
+
+#define UPDATES 100000
+
+static float Noise(float amplitude) {
+    return amplitude * ((float)rand() / RAND_MAX - 0.5f);
+}
+
+/*
+ * The mean of the last window samples of history, summed in doubles.
+ */
+static double ReferenceMean(const float *history, int length, int window) {
+    double sum = 0;
+    int i, count = length < window ? length : window;
+
+    for (i = length - count; i < length; i++) {
+        sum += history[i];
+    }
+    return sum / count;
+}
+
+/*
+ * Every window size follows the exact mean of the samples so far, through
+ * the warm up and across window changes.
+ */
+static void TestMovingAverage() {
+    static float history[UPDATES];
+    MovingAverage filter;
+    double worst = 0, error;
+    int window, n;
+
+    srand(7);
+    for (window = 1; window <= FILTER_MAX_WINDOW; window++) {
+        MovingAverageInit(&filter, window);
+        for (n = 0; n < 2000; n++) {
+            history[n] = 100 + Noise(20);
+            error = MovingAverageUpdate(&filter, history[n]) - ReferenceMean(history, n + 1, window);
+            if (error < 0) {
+                error = -error;
+            }
+            if (error > worst) {
+                worst = error;
+            }
+        }
+    }
+    printf("  moving average, worst error over windows 1 to %d: %.3g\n", FILTER_MAX_WINDOW, worst);
+    CHECK(worst < 1e-4);
+
+    // a window change starts over from the next sample
+    MovingAverageInit(&filter, 4);
+    for (n = 0; n < 10; n++) {
+        MovingAverageUpdate(&filter, 1000);
+    }
+    MovingAverageSetWindow(&filter, 8);
+    for (n = 0; n < 12; n++) {
+        history[n] = (float)n;
+        CHECK_NEAR(MovingAverageUpdate(&filter, (float)n), ReferenceMean(history, n + 1, 8), 1e-6);
+    }
+
+    MovingAverageInit(&filter, 0);
+    CHECK(filter.window == 1);
+    MovingAverageInit(&filter, 200);
+    CHECK(filter.window == FILTER_MAX_WINDOW);
+}
+
+/*
+ * The running sum alone, the way MovingAverageUpdate would be without the
+ * recompute on wrap.
+ */
+static float RunningSumUpdate(MovingAverage *filter, float sample) {
+    if (filter->count < filter->window) {
+        filter->count++;
+    } else {
+        filter->sum -= filter->samples[filter->index];
+    }
+    filter->samples[filter->index] = sample;
+    filter->sum += sample;
+    if (++filter->index >= filter->window) {
+        filter->index = 0;
+    }
+    return filter->sum / filter->count;
+}
+
+/*
+ * A large signal that drops to a small one is where the running sum loses
+ * out: the rounding of adding and removing the large samples is left behind
+ * in the sum. Recomputing on wrap clears it within one window.
+ */
+static void TestMovingAverageWrap() {
+    MovingAverage filter, running;
+    double error, running_error = 0, worst = 0;
+    int n, cycle;
+
+    srand(11);
+    MovingAverageInit(&filter, 16);
+    MovingAverageInit(&running, 16);
+    for (cycle = 0; cycle < 50; cycle++) {
+        for (n = 0; n < 1000; n++) {
+            float sample = 30000 + Noise(3000);
+            MovingAverageUpdate(&filter, sample);
+            RunningSumUpdate(&running, sample);
+        }
+        for (n = 0; n < 32; n++) {
+            MovingAverageUpdate(&filter, 0.5f);
+            RunningSumUpdate(&running, 0.5f);
+        }
+    }
+    error = filter.output - 0.5;
+    running_error = running.sum / running.count - 0.5;
+    worst = error < 0 ? -error : error;
+
+    printf("  moving average of 0.5 after large samples: %.3g off with the recompute, %.3g without\n",
+           worst, running_error < 0 ? -running_error : running_error);
+    CHECK(filter.output == 0.5f);
+    CHECK(running_error > 1e-3 || running_error < -1e-3);
+}
+
+/*
+ * Matches a double precision low pass, primes from the first sample and
+ * clamps alpha to [0, 1].
+ */
+static void TestLowPass() {
+    LowPassFilter filter;
+    double reference = 0, worst = 0, error;
+    int n;
+
+    srand(13);
+    LowPassInit(&filter, 0.05f);
+    for (n = 0; n < UPDATES; n++) {
+        float sample = 50 + Noise(10) + (n % 5000 < 2500 ? 20 : 0);
+        reference = n == 0 ? sample : reference + (double)0.05f * (sample - reference);
+        error = LowPassUpdate(&filter, sample) - reference;
+        if (error < 0) {
+            error = -error;
+        }
+        if (error > worst) {
+            worst = error;
+        }
+    }
+    printf("  low pass, worst error from double precision: %.3g\n", worst);
+    CHECK(worst < 1e-4);
+
+    LowPassInit(&filter, 0.5f);
+    CHECK(LowPassUpdate(&filter, 8) == 8);
+    CHECK(LowPassUpdate(&filter, 0) == 4);
+    CHECK(LowPassUpdate(&filter, 0) == 2);
+
+    LowPassSetAlpha(&filter, 2);
+    CHECK(filter.alpha == 1);
+    LowPassSetAlpha(&filter, -1);
+    CHECK(filter.alpha == 0);
+    CHECK(LowPassUpdate(&filter, 100) == 2);
+}
+
+static int CompareFloats(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * The sorted window gives the same median as a full sort for every window
+ * up to FILTER_MAX_MEDIAN, with ties, spikes and already sorted or reversed
+ * input, through the warm up.
+ */
+static void TestMedian() {
+    static const char *patterns[] = { "random", "ties", "ascending", "descending" };
+    MedianFilter filter;
+    float history[2000], sorted[FILTER_MAX_MEDIAN];
+    int window, pattern, n, count, mismatches = 0;
+
+    srand(17);
+    for (window = 1; window <= FILTER_MAX_MEDIAN; window++) {
+        for (pattern = 0; pattern < 4; pattern++) {
+            MedianInit(&filter, window);
+            for (n = 0; n < 2000; n++) {
+                if (pattern == 0) {
+                    history[n] = Noise(100) + (rand() % 50 == 0 ? 1000 : 0);
+                } else if (pattern == 1) {
+                    history[n] = (float)(rand() % 3);
+                } else if (pattern == 2) {
+                    history[n] = (float)n;
+                } else {
+                    history[n] = (float)-n;
+                }
+                count = n + 1 < window ? n + 1 : window;
+                memcpy(sorted, &history[n + 1 - count], count * sizeof(float));
+                qsort(sorted, count, sizeof(float), CompareFloats);
+                if (MedianUpdate(&filter, history[n]) != sorted[count / 2]) {
+                    if (mismatches++ == 0) {
+                        printf("  median mismatch, window %d, %s input, sample %d\n", window, patterns[pattern], n);
+                    }
+                }
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+
+    // single spikes are removed by a window of 3
+    MedianInit(&filter, 3);
+    MedianUpdate(&filter, 20);
+    MedianUpdate(&filter, 20);
+    CHECK(MedianUpdate(&filter, 500) == 20);
+    CHECK(MedianUpdate(&filter, 21) == 21);
+
+    // even windows take the upper of the middle pair
+    MedianInit(&filter, 4);
+    MedianUpdate(&filter, 1);
+    MedianUpdate(&filter, 2);
+    MedianUpdate(&filter, 3);
+    CHECK(MedianUpdate(&filter, 4) == 3);
+
+    // a new window starts over from the samples that follow
+    MedianSetWindow(&filter, 3);
+    CHECK(MedianUpdate(&filter, 10) == 10);
+    CHECK(MedianUpdate(&filter, 30) == 30);
+    CHECK(MedianUpdate(&filter, 20) == 20);
+
+    MedianInit(&filter, 20);
+    CHECK(filter.window == FILTER_MAX_MEDIAN);
+}
+
+int main() {
+    TestMovingAverage();
+    TestMovingAverageWrap();
+    TestLowPass();
+    TestMedian();
+    return CHECK_DONE();
+}
@@ -0,0 +1,253 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "check.h"
+#include "motor/pi_control.h"
+
+#define UPDATES 20000
+#define DUTY_LSB (1.0 / PI_ONE)
+
+/*
+ * The controller of pi_control.c written out in doubles, used as the
+ * reference. Gains and limits are the fixed point values converted back, so
+ * any difference comes from the integer arithmetic alone.
+ */
+typedef struct ReferencePI {
+    double kp, ki, kb;
+    double integrator, integrator_limit;
+    double out_min, out_max, max_step;
+    double output;
+} ReferencePI;
+
+static double Clamp(double value, double low, double high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+static double ToFloat(int32_t value) {
+    return (double)value / PI_ONE;
+}
+
+static void ReferenceInit(ReferencePI *ref, const PIController *pi) {
+    ref->kp = ToFloat(pi->kp);
+    ref->ki = ToFloat(pi->ki);
+    ref->kb = ToFloat(pi->kb);
+    ref->integrator = ToFloat(pi->integrator);
+    ref->integrator_limit = ToFloat(pi->integrator_limit);
+    ref->out_min = ToFloat(pi->out_min);
+    ref->out_max = ToFloat(pi->out_max);
+    ref->max_step = pi->max_step == INT32_MAX ? 1e9 : ToFloat(pi->max_step);
+    ref->output = ToFloat(pi->output);
+}
+
+static double ReferenceUpdate(ReferencePI *ref, int32_t error) {
+    double proportional, unlimited, output;
+
+    proportional = Clamp(ref->kp * error, -64, 64);
+    ref->integrator = Clamp(ref->integrator + ref->ki * error, -ref->integrator_limit, ref->integrator_limit);
+    unlimited = proportional + ref->integrator;
+    output = Clamp(unlimited, ref->out_min, ref->out_max);
+    output = Clamp(output, ref->output - ref->max_step, ref->output + ref->max_step);
+    if (output != unlimited) {
+        ref->integrator = Clamp(ref->integrator + ref->kb * (output - unlimited),
+                                -ref->integrator_limit, ref->integrator_limit);
+    }
+    ref->output = output;
+    return output;
+}
+
+/*
+ * Speed loop gains and limits from speed.c (direct duty mode).
+ */
+static void SpeedLoop(PIController *pi) {
+    PIControllerInit(pi, PI_FROM_FLOAT(0.00003), PI_FROM_FLOAT(0.0000003), 0, PI_FROM_FLOAT(0.95));
+    PIControllerSetLimits(pi, 0, PI_FROM_FLOAT(0.95), PI_FROM_FLOAT(0.95), PI_FROM_FLOAT(0.0005));
+}
+
+/*
+ * Follows the float reference through setpoint steps that saturate the output
+ * in both directions, with noise on top, for a range of back-calculation gains.
+ */
+static void TestMatchesReference() {
+    static const double kbs[] = { 1.0, 0.5, 0.1, 0.0 };
+    PIController pi;
+    ReferencePI ref;
+    double worst = 0, difference;
+    int32_t error;
+    unsigned k, n;
+
+    srand(456);
+    for (k = 0; k < sizeof(kbs) / sizeof(kbs[0]); k++) {
+        SpeedLoop(&pi);
+        PIControllerSetBackCalculation(&pi, PI_FROM_FLOAT(kbs[k]));
+        ReferenceInit(&ref, &pi);
+        for (n = 0; n < UPDATES; n++) {
+            // 2.5 s at each of +/-6000 RPM, 0 and +/-300 RPM of error
+            static const int32_t steps[] = { 6000, 300, 0, -300, -6000, 0, 300 };
+            error = steps[(n / 2500) % 7] + rand() % 101 - 50;
+            difference = ToFloat(PIControllerUpdate(&pi, error)) - ReferenceUpdate(&ref, error);
+            if (difference < 0) {
+                difference = -difference;
+            }
+            if (difference > worst) {
+                worst = difference;
+            }
+        }
+    }
+
+    // the back-calculation term is rounded to an LSB on every limited update
+    printf("  worst difference from the float reference: %.3g duty (%.0f LSB)\n", worst, worst / DUTY_LSB);
+    CHECK(worst < 1e-5);
+}
+
+/*
+ * The output never leaves its range however large the error, and the
+ * integrator never leaves its clamp.
+ */
+static void TestSaturation() {
+    PIController pi;
+    int n;
+
+    PIControllerInit(&pi, PI_FROM_FLOAT(0.5), PI_FROM_FLOAT(0.01), PI_FROM_FLOAT(-0.8), PI_FROM_FLOAT(0.9));
+    for (n = 0; n < 1000; n++) {
+        PIControllerUpdate(&pi, 1000000);
+        CHECK(pi.output <= PI_FROM_FLOAT(0.9));
+        CHECK(pi.integrator <= pi.integrator_limit);
+    }
+    CHECK(pi.output == PI_FROM_FLOAT(0.9));
+
+    for (n = 0; n < 1000; n++) {
+        PIControllerUpdate(&pi, INT32_MIN + 1);
+        CHECK(pi.output >= PI_FROM_FLOAT(-0.8));
+        CHECK(pi.integrator >= -pi.integrator_limit);
+    }
+    CHECK(pi.output == PI_FROM_FLOAT(-0.8));
+}
+
+/*
+ * Held in saturation, full back-calculation parks the integrator where the
+ * unlimited output equals the limit, so the output comes off the limit on the
+ * first update after the error reverses. Without it the integrator winds up
+ * to its clamp and the output stays pinned for many updates.
+ */
+static void TestBackCalculation() {
+    PIController pi;
+    int n, with, without;
+    int32_t kp = PI_FROM_FLOAT(0.001), ki = PI_FROM_FLOAT(0.0001), max = PI_FROM_FLOAT(0.95);
+
+    // the integrator clamp is left loose so it doesn't hide the windup
+    PIControllerInit(&pi, kp, ki, 0, max);
+    PIControllerSetLimits(&pi, 0, max, PI_FROM_FLOAT(4.0), INT32_MAX);
+    for (n = 0; n < 5000; n++) {
+        PIControllerUpdate(&pi, 500);
+    }
+    CHECK(pi.output == max);
+    CHECK_NEAR(ToFloat(pi.integrator), ToFloat(max) - ToFloat(kp) * 500, 2 * DUTY_LSB);
+    for (with = 1; PIControllerUpdate(&pi, -50) == max; with++) {
+    }
+
+    PIControllerInit(&pi, kp, ki, 0, max);
+    PIControllerSetLimits(&pi, 0, max, PI_FROM_FLOAT(4.0), INT32_MAX);
+    PIControllerSetBackCalculation(&pi, 0);
+    for (n = 0; n < 5000; n++) {
+        PIControllerUpdate(&pi, 500);
+    }
+    CHECK(pi.integrator == pi.integrator_limit);
+    for (without = 1; PIControllerUpdate(&pi, -50) == max; without++) {
+    }
+
+    printf("  updates pinned at the limit after reversing: %d with back-calculation, %d without\n", with, without);
+    CHECK(with == 1);
+    CHECK(without > 10);
+}
+
+/*
+ * No update moves the output further than the rate limit, a step is followed
+ * at exactly the limit, and back-calculation keeps the integrator from winding
+ * up while the output ramps so the ramp stops at the target.
+ */
+static void TestRateLimit() {
+    PIController pi;
+    int32_t previous, step, largest = 0;
+    double speed = 0;
+    int n, ramp = 0;
+
+    // a first order plant of 5000 RPM at full duty with a 100 update lag
+    SpeedLoop(&pi);
+    for (n = 0; n < 10000; n++) {
+        previous = pi.output;
+        PIControllerUpdate(&pi, 2000 - (int32_t)speed);
+        speed += (ToFloat(pi.output) * 5000 - speed) / 100;
+        step = pi.output - previous;
+        if (step < 0) {
+            step = -step;
+        }
+        if (step > largest) {
+            largest = step;
+        }
+        if (step == PI_FROM_FLOAT(0.0005)) {
+            ramp++;
+        }
+    }
+
+    // integral action drives the error to zero at 0.4 duty
+    printf("  largest step %.6f duty over %d limited updates, settled at %.4f\n",
+           ToFloat(largest), ramp, ToFloat(pi.output));
+    CHECK(largest <= PI_FROM_FLOAT(0.0005));
+    // the proportional kick of the 2000 RPM error alone is 0.06 duty, 120 limited updates
+    CHECK(ramp >= 120);
+    CHECK_NEAR(ToFloat(pi.output), 0.4, 0.01);
+}
+
+/*
+ * A reset output is kept exactly and carried on from without a jump.
+ */
+static void TestReset() {
+    PIController pi;
+
+    SpeedLoop(&pi);
+    PIControllerReset(&pi, PI_FROM_FLOAT(0.3));
+    CHECK(pi.output == PI_FROM_FLOAT(0.3));
+    PIControllerUpdate(&pi, 0);
+    CHECK(pi.output == PI_FROM_FLOAT(0.3));
+    PIControllerReset(&pi, PI_FROM_FLOAT(2.0));
+    CHECK(pi.output == PI_FROM_FLOAT(0.95));
+}
+
+/*
+ * A held integrator stays put through errors and limited updates, the
+ * proportional term still acts, and it integrates again once released.
+ */
+static void TestHold() {
+    PIController pi;
+    int32_t integrator;
+    int n;
+
+    SpeedLoop(&pi);
+    PIControllerReset(&pi, PI_FROM_FLOAT(0.3));
+    integrator = pi.integrator;
+    PIControllerHoldIntegrator(&pi, true);
+    for (n = 0; n < UPDATES; n++) {
+        PIControllerUpdate(&pi, 50000);
+        CHECK(pi.integrator == integrator);
+    }
+    // limited at the top, with nothing wound up or backed off underneath
+    CHECK(pi.output == PI_FROM_FLOAT(0.95));
+    for (n = 0; n < UPDATES; n++) {
+        PIControllerUpdate(&pi, 0);
+    }
+    CHECK(pi.output == integrator);
+
+    // an error small enough to stay inside the rate limit
+    PIControllerHoldIntegrator(&pi, false);
+    PIControllerUpdate(&pi, 10);
+    CHECK(pi.integrator > integrator);
+}
+
+int main() {
+    TestMatchesReference();
+    TestSaturation();
+    TestBackCalculation();
+    TestRateLimit();
+    TestReset();
+    TestHold();
+    return CHECK_DONE();
+}
@@ -0,0 +1,266 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "check.h"
+
+// CalculateTemperature() and the calibration constants are static, so the
+// module is built into the test
+#include "motor/temperature.c"
+
+#define RAM_9_TYPICAL 19000
+#define AMBIENT_MIN -40 // C, the sensor's operating range
+#define AMBIENT_MAX 85
+#define OBJECT_MIN -20 // C, what the motor case can plausibly reach
+#define OBJECT_MAX 200
+#define ERROR_BOUND 0.01 // C, a small fraction of the sensor's own accuracy
+#define PUBLISHED_BOUND 0.1 // C, as far as rounding the readings to integers moves them
+
+/*
+ * Raw EEPROM calibration words of an MLX90632, the example values from the
+ * Melexis driver library. Hb is 0 on that part, which would leave its term
+ * unchecked, so it is given a tenth of a degree here.
+ */
+static const int32_t RAW_PR = 0x00587F5B, RAW_PG = 0x04A10289, RAW_PT = (int32_t)0xFFF966F8;
+static const int32_t RAW_PO = 0x00001E0F, RAW_FA = 53855361, RAW_FB = 42874149, RAW_GA = -14556410;
+static const int16_t RAW_GB = 9728, RAW_KA = 10752, RAW_HA = 16384, RAW_HB = 1638;
+
+// the same constants in double, scaled as the firmware did before it moved to float
+static double Gb_d, Ka_d, Ha_d, Hb_d, Fa_d, Fb_d, Ga_d, Pr_d, Po_d, Pg_d, Pt_d;
+
+/*
+ * A stand in MLX90632 on I2C2, answering the driver's transfers from a
+ * register map. Every byte completes as soon as it starts, and the test runs
+ * as main, so RunQueue() polls rather than pending on the interrupt. Writes
+ * store the value as it is, so clearing REG_STATUS drops the new data bit.
+ */
+static uint16_t sensor_registers[0x10000];
+static uint16_t bus_address;
+static uint8_t bus_bytes[4];
+static uint32_t bus_written, bus_read;
+
+BIOS_ThreadType BIOS_getThreadType(void) {
+    return BIOS_ThreadType_Main;
+}
+
+bool I2CMasterIntStatus(uint32_t ui32Base, bool bMasked) {
+    return true;
+}
+
+uint32_t I2CMasterErr(uint32_t ui32Base) {
+    return I2C_MASTER_ERR_NONE;
+}
+
+void I2CMasterSlaveAddrSet(uint32_t ui32Base, uint8_t ui8SlaveAddr, bool bReceive) {
+    if (bReceive) {
+        bus_read = 0;
+    } else {
+        bus_written = 0;
+    }
+}
+
+void I2CMasterDataPut(uint32_t ui32Base, uint8_t ui8Data) {
+    if (bus_written < sizeof(bus_bytes)) {
+        bus_bytes[bus_written++] = ui8Data;
+    }
+    if (bus_written == 2) {
+        bus_address = (bus_bytes[0] << 8) | bus_bytes[1];
+    } else if (bus_written == 4) {
+        sensor_registers[bus_address] = (bus_bytes[2] << 8) | bus_bytes[3];
+    }
+}
+
+uint32_t I2CMasterDataGet(uint32_t ui32Base) {
+    uint16_t word = sensor_registers[(uint16_t)(bus_address + bus_read / 2)];
+
+    return (bus_read++ % 2 == 0) ? word >> 8 : word & 0xff;
+}
+
+static void PutLong(uint16_t address, int32_t value) {
+    sensor_registers[address] = (uint32_t)value & 0xffff; // least significant word first
+    sensor_registers[address + 1] = (uint32_t)value >> 16;
+}
+
+/*
+ * Loads the calibration words into the sensor's EEPROM and connects to it,
+ * so the firmware decodes its single precision constants itself. The double
+ * precision ones are worked out with pow().
+ */
+static void LoadCalibration() {
+    sensor_registers[0x242E] = RAW_GB;
+    sensor_registers[0x242F] = RAW_KA;
+    sensor_registers[0x2481] = RAW_HA;
+    sensor_registers[0x2482] = RAW_HB;
+    PutLong(0x2428, RAW_FA);
+    PutLong(0x242A, RAW_FB);
+    PutLong(0x242C, RAW_GA);
+    PutLong(0x240C, RAW_PR);
+    PutLong(0x2412, RAW_PO);
+    PutLong(0x240E, RAW_PG);
+    PutLong(0x2410, RAW_PT);
+    ConnectWithTemperatureSensor();
+
+    Gb_d = RAW_GB * pow(2, -10);
+    Ka_d = RAW_KA * pow(2, -10);
+    Ha_d = RAW_HA * pow(2, -14);
+    Hb_d = RAW_HB * pow(2, -14);
+    Fa_d = RAW_FA * pow(2, -46);
+    Fb_d = RAW_FB * pow(2, -36);
+    Ga_d = RAW_GA * pow(2, -36);
+    Pr_d = RAW_PR * pow(2, -8);
+    Po_d = RAW_PO * pow(2, -8);
+    Pg_d = RAW_PG * pow(2, -20);
+    Pt_d = RAW_PT * pow(2, -44);
+}
+
+/*
+ * Ambient temperature in double precision, section 12 of the datasheet.
+ */
+static double ReferenceAmbient(int16_t RAM_6, int16_t RAM_9) {
+    double VRTA = RAM_9 + Gb_d * (RAM_6 / 12.0);
+    double AMB = ((RAM_6 / 12.0) / VRTA) * pow(2, 19);
+
+    return Po_d + ((AMB - Pr_d) / Pg_d) + Pt_d * pow((AMB - Pr_d), 2);
+}
+
+/*
+ * The object temperature conversion as it was in double precision with pow().
+ */
+static double ReferenceObject(double temperature_old, int16_t RAM_6, int16_t RAM_9, int16_t RAM_A, int16_t RAM_B) {
+    double Ta_C = ReferenceAmbient(RAM_6, RAM_9), Ta_K = Ta_C + KELVIN_OFFSET, To_K;
+    double S = (RAM_A + RAM_B) / 2.0;
+    double VRTO = RAM_9 + Ka_d * (RAM_6 / 12.0);
+    double STO = ((S / 12.0) / VRTO) * pow(2, 19);
+
+    To_K = (STO / (Fa_d * Ha_d * (1.0 + Ga_d * (temperature_old - TO_O) + Fb_d * (Ta_C - TA_O)))) + pow(Ta_K, 4);
+    return pow(To_K, 0.25) - KELVIN_OFFSET - Hb_d;
+}
+
+/*
+ * The RAM_6 reading that gives an ambient temperature, by inverting the
+ * reference conversion.
+ */
+static int16_t AmbientReading(double ambient, int16_t RAM_9) {
+    double x = (ambient - Po_d) * Pg_d, r;
+    int i;
+
+    // Pt is tiny, so Newton from the linear solution settles straight away
+    for (i = 0; i < 5; i++) {
+        x -= (Po_d + x / Pg_d + Pt_d * x * x - ambient) / (1 / Pg_d + 2 * Pt_d * x);
+    }
+    r = (x + Pr_d) * RAM_9 / (pow(2, 19) - Gb_d * (x + Pr_d));
+    return (int16_t)lround(12 * r);
+}
+
+/*
+ * The object signal S = (RAM_A + RAM_B) / 2 that gives an object temperature
+ * against the ambient the RAM_6 reading decodes to.
+ */
+static int16_t ObjectReading(double object, int16_t RAM_6, int16_t RAM_9) {
+    double Ta_C = ReferenceAmbient(RAM_6, RAM_9);
+    double STO = (pow(object + Hb_d + KELVIN_OFFSET, 4) - pow(Ta_C + KELVIN_OFFSET, 4)) *
+                 (Fa_d * Ha_d * (1.0 + Ga_d * (object - TO_O) + Fb_d * (Ta_C - TA_O)));
+
+    return (int16_t)lround(STO * (RAM_9 + Ka_d * (RAM_6 / 12.0)) * 12 / pow(2, 19));
+}
+
+/*
+ * The single precision conversion follows the double precision one to within
+ * ERROR_BOUND over the whole ambient and object range.
+ */
+static void TestAgainstReference() {
+    double worst = 0, worst_ambient = 0, worst_object = 0, worst_inversion = 0, error, reference;
+    int16_t RAM_6, S;
+    int ambient, object;
+
+    for (ambient = AMBIENT_MIN; ambient <= AMBIENT_MAX; ambient++) {
+        RAM_6 = AmbientReading(ambient, RAM_9_TYPICAL);
+        for (object = OBJECT_MIN; object <= OBJECT_MAX; object++) {
+            S = ObjectReading(object, RAM_6, RAM_9_TYPICAL);
+            reference = ReferenceObject(object, RAM_6, RAM_9_TYPICAL, S, S);
+            error = fabs(CalculateTemperature(object, 0, RAM_6, RAM_9_TYPICAL, S, S) - reference);
+            if (error > worst) {
+                worst = error;
+                worst_ambient = ambient;
+                worst_object = object;
+            }
+            if (fabs(reference - object) > worst_inversion) {
+                worst_inversion = fabs(reference - object);
+            }
+        }
+    }
+    printf("  worst error from double precision: %.3g C at ambient %g C, object %g C\n",
+           worst, worst_ambient, worst_object);
+    CHECK(worst < ERROR_BOUND);
+
+    // the readings really span the range, short of rounding them to integers
+    CHECK(worst_inversion < 0.1);
+}
+
+/*
+ * The calibration comes off the sensor decoded, Hb included, and the
+ * connection leaves it measuring continuously.
+ */
+static void TestConnect() {
+    CHECK(!IsTemperatureCalibrationCached());
+    CHECK(GetTemperatureFailures() == 0);
+    CHECK(sensor_registers[REG_CONTROL] == 0x06);
+    CHECK_NEAR(Hb, Hb_d, 1e-7);
+    CHECK_NEAR(FaHa, Fa_d * Ha_d, Fa_d * Ha_d * 1e-6);
+    CHECK_NEAR(inverse_Pg, 1 / Pg_d, 1e-6 / Pg_d);
+}
+
+/*
+ * Puts a measurement in the sensor's RAM for the given cycle position, with
+ * the object signal in the pair of words that position uses and rubbish in
+ * the other, and flags it as new.
+ */
+static void PutMeasurement(int16_t RAM_6, int16_t RAM_9, int16_t S, int cycle_position) {
+    int16_t used = cycle_position % 2 == 0 ? REG_RAM_4 : REG_RAM_7;
+    int16_t unused = cycle_position % 2 == 0 ? REG_RAM_7 : REG_RAM_4;
+
+    sensor_registers[used] = S;
+    sensor_registers[used + 1] = S;
+    sensor_registers[unused] = -S;
+    sensor_registers[unused + 1] = 0x7fff;
+    sensor_registers[REG_RAM_6] = RAM_6;
+    sensor_registers[REG_RAM_9] = RAM_9;
+    sensor_registers[REG_STATUS] = (cycle_position << 2) | 1;
+}
+
+/*
+ * The value GetTemperature() publishes is the object temperature in degrees
+ * C, once UpdateTemperature() has iterated on it, for both pairs of RAM words.
+ * A read with no new measurement leaves it alone.
+ */
+static void TestPublished() {
+    static const int points[][2] = {{25, 25}, {20, 60}, {40, 150}, {-10, -5}, {85, 200}};
+    double published;
+    int16_t RAM_6, S;
+    unsigned i;
+    int n;
+
+    for (i = 0; i < sizeof(points) / sizeof(points[0]); i++) {
+        RAM_6 = AmbientReading(points[i][0], RAM_9_TYPICAL);
+        S = ObjectReading(points[i][1], RAM_6, RAM_9_TYPICAL);
+        for (n = 0; n < CALCULATION_ITERATIONS + 1; n++) {
+            PutMeasurement(RAM_6, RAM_9_TYPICAL, S, n + i);
+            CHECK(UpdateTemperature());
+        }
+        CHECK_NEAR(GetTemperature(), points[i][1], PUBLISHED_BOUND);
+    }
+
+    published = GetTemperature();
+    sensor_registers[REG_STATUS] = 0;
+    CHECK(!UpdateTemperature());
+    CHECK(GetTemperature() == published);
+    CHECK(GetTemperatureFailures() == 0);
+    printf("  published %.2f C for an object at %d C\n", published, points[i - 1][1]);
+}
+
+int main() {
+    LoadCalibration();
+    TestConnect();
+    TestAgainstReference();
+    TestPublished();
+    return CHECK_DONE();
+}
@@ -0,0 +1,89 @@
+#include <stdint.h>
+#include <math.h>
+#include "check.h"
+
+// the ambient estimate is static, so the module is built into the test
+#include "motor/thermal.c"
+
+#define BLOCK_PERIOD 0.00025f // s, one acquisition block at the default rate
+#define BLOCKS_PER_READING 2000 // the sensor reads twice a second
+#define TRUE_AMBIENT 25.0
+
+/*
+ * A winding that follows the model equation exactly, stepped in double
+ * precision, standing in for the motor the sensor reads.
+ */
+static double Winding(double temperature, double ambient, double current_mean_square, double period) {
+    double steady_state = ambient + THERMAL_RISE_PER_AMP2 * current_mean_square;
+
+    return temperature + (steady_state - temperature) * (period / THERMAL_TIME_CONSTANT);
+}
+
+/*
+ * Heating goes with the mean of I^2. A current switching between 0 and 2 A
+ * has a mean of 1 A but heats the winding as 2 A^2 does.
+ */
+static void TestMeanSquareHeating() {
+    float mean_square = (0 * 0 + 2 * 2) / 2.0f;
+    int n;
+
+    ThermalModelInit(TRUE_AMBIENT);
+    for (n = 0; n < 10 * THERMAL_TIME_CONSTANT / BLOCK_PERIOD; n++) {
+        ThermalModelUpdate(mean_square, BLOCK_PERIOD);
+    }
+    CHECK_NEAR(GetPredictedTemperature(), TRUE_AMBIENT + THERMAL_RISE_PER_AMP2 * 2, 0.01);
+}
+
+/*
+ * Runs the winding and the model side by side for the given time, with the
+ * model corrected by a reading of the winding twice a second.
+ *
+ * Output: the largest gap between the model and the winding over the last
+ * minute.
+ */
+static double Track(double *winding, double current_mean_square, double seconds) {
+    double worst = 0;
+    int n, blocks = seconds / BLOCK_PERIOD;
+
+    for (n = 1; n <= blocks; n++) {
+        *winding = Winding(*winding, TRUE_AMBIENT, current_mean_square, BLOCK_PERIOD);
+        ThermalModelUpdate(current_mean_square, BLOCK_PERIOD);
+        if (n % BLOCKS_PER_READING == 0) {
+            ThermalModelCorrect(*winding);
+        }
+        if (n > blocks - 60 / BLOCK_PERIOD && fabs(GetPredictedTemperature() - *winding) > worst) {
+            worst = fabs(GetPredictedTemperature() - *winding);
+        }
+    }
+    return worst;
+}
+
+/*
+ * Started on a motor still warm from a previous run, the model takes the
+ * first reading as the ambient. The readings pull the ambient estimate back
+ * to the real one while the winding cools and heats, and the prediction
+ * between readings stays close throughout.
+ */
+static void TestAmbientLearning() {
+    double winding = 45, idle, loaded;
+
+    ThermalModelInit(winding);
+    CHECK(ambient == 45);
+
+    idle = Track(&winding, 0, 20 * 60);
+    printf("  ambient estimate %.2f C after 20 minutes idle, true %.0f C\n", ambient, TRUE_AMBIENT);
+    CHECK_NEAR(ambient, TRUE_AMBIENT, 1);
+    CHECK(idle < 0.05);
+
+    loaded = Track(&winding, 4, 20 * 60);
+    printf("  ambient estimate %.2f C after 20 minutes at 2 A, winding %.1f C, model %.1f C\n",
+           ambient, winding, GetPredictedTemperature());
+    CHECK_NEAR(ambient, TRUE_AMBIENT, 0.1);
+    CHECK(loaded < 0.05);
+}
+
+int main() {
+    TestMeanSquareHeating();
+    TestAmbientLearning();
+    return CHECK_DONE();
+}
@@ -11,10 +11,11 @@
 #include <ti/catalog/arm/cortexm4/tiva/ce/sysctl.h>
 #include <inc/hw_memmap.h>
 #include "drivers/pinout.h"
-#include "motor/current.h"
+#include "motor/acquisition.h"
 #include "motor/speed.h"
 #include "motor/temperature.h"
 #include "motor/measurement.h"
+#include "motor/timing.h"
 #include "ui/main.h"
 
 #define SECONDS_SINCE_EPOCH (1526892415 + (10 * 60 * 60))
@@ -22,6 +23,7 @@
 int initialise_hardware() {
     // call all hardware setup functions
     // if any return -1, we are in a faulty state
+    TimingInit(); // boot time is measured from here
     StartADCSampling();
     ConnectWithTemperatureSensor();
     ConnectWithMotor();
@@ -0,0 +1,300 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_adc.h"
+#include "driverlib/adc.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/pwm.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/udma.h"
+#include "acquisition.h"
+#include "motorLib.h"
+
+#define VCC 5 // According to sensor datasheet
+#define SENSITIVITY 0.2f // 200 millVolts/A = 0.2 V/A for 10 AB (our current sensor)
+#define SEQUENCE_NUMBER 0 // 8 step FIFO
+#define ADC_PRIORITY 0
+#define RESOLUTION 4095 // max digital value for 12 bit sample
+#define REF_VOLTAGE_PLUS 3.3f // Reference voltage used for ADC process, given in page 2149 of TM4C129XNCZAD Microcontroller Data Sheet
+#define NEUTRAL_VIOUT (0.5f*VCC)
+#define VOLTS_PER_COUNT (REF_VOLTAGE_PLUS / RESOLUTION)
+
+// Sampling runs on ADC1, which is otherwise unused. ADC0 belongs to the touch
+// screen, and its driver turns on 4x hardware oversampling, which applies to
+// every sequence of that ADC and would quarter the conversion rate here.
+//
+// The sample clock is PWM0 generator 0 with its outputs left disabled. The
+// general purpose timers can't be used: 0, 2 and 3 drive the motor, 1 is the
+// SYS/BIOS clock, and any timer ADC trigger would also fire the touch screen
+// sequence, which listens for Timer 5.
+//
+// The sample clock runs from the system clock like the motor PWM, and its
+// period is kept a whole number of motor PWM periods, so every pass lands at
+// the same place in the motor PWM period. The trigger is placed inside the on
+// pulse, where the current sensor carries the phase current (off the pulse it
+// reads nothing but the freewheeling diodes). The current read is then the
+// phase current rather than the bus current.
+#ifdef MOTOR_PWM_MODULE
+// With the generators started together, a trigger half a motor period before
+// the generator 0 zero lands on the top of the motor count: the middle of the
+// centre-aligned on pulse, where the phase current is its average.
+#define SAMPLE_PWM_CLOCK MOTOR_PWM_CLOCK
+#define MOTOR_PERIOD MOTOR_PWM_PERIOD
+#define SAMPLE_LEAD (MOTOR_PWM_PERIOD / 2) // clocks from the trigger to the end of the motor period
+#else
+// The timers count down with inverted outputs, so each on pulse ends the
+// timer period. SyncAcquisitionSampleClock() restarts generator 0 with the
+// timers, and the trigger comes just before the timers reach zero. Pulses
+// shorter than the lead read as no current, and on the board the ADC's sample
+// and hold window has to fit in the pulse too, so the lightest duty cycles
+// read low.
+#define SAMPLE_PWM_CLOCK PWM_SYSCLK_DIV_1
+#define MOTOR_PERIOD MOTOR_TIMER_PERIOD
+#define SAMPLE_LEAD 2 // clocks from the trigger to the end of the motor period
+#endif
+#define SAMPLE_CLOCK_SPEED 120000000 // PWM clock is the system clock
+#define MIN_SAMPLE_RATE (SAMPLE_CLOCK_SPEED / 65535 + 1) // 16 bit generator counter
+#define MAX_SAMPLE_RATE 100000
+
+#define BLOCK_SAMPLES (ACQUISITION_BLOCK_PASSES * ACQUISITION_CHANNELS)
+
+/*
+ * A single ADC input sampled on every sequencer pass. A raw reading in counts
+ * becomes raw * scale + offset in the channel's unit.
+ */
+typedef struct AcquisitionChannel {
+    uint32_t adc_channel;
+    uint32_t gpio_base;
+    uint8_t gpio_pin;
+    float scale;
+    float offset;
+} AcquisitionChannel;
+
+/*
+ * Function Prototypes
+ */
+void StartADCSampling();
+void SetAcquisitionSampleRate(uint32_t rate);
+uint32_t GetAcquisitionSampleRate();
+void SyncAcquisitionSampleClock();
+void SetAcquisitionCalibration(ACQUISITION_CHANNEL channel, float scale, float offset);
+void SetAcquisitionBlockCallback(AcquisitionBlockCallback callback);
+float GetAcquisitionValue(ACQUISITION_CHANNEL channel);
+double GetCurrentValue();
+uint32_t GetAcquisitionBlockCount();
+void AcquisitionADCIntHandler();
+static void ArmBuffer(uint32_t select, uint16_t *buffer);
+static void DecimateBlock(const uint16_t *samples, AcquisitionBlock *block);
+
+// Sequencer steps in order, indexed by ACQUISITION_CHANNEL (page 11 of the DK-TM4C129X User's Guide)
+static AcquisitionChannel channels[ACQUISITION_CHANNELS] = {
+    { ADC_CTL_CH0, GPIO_PORTE_BASE, GPIO_PIN_3, VOLTS_PER_COUNT / SENSITIVITY, -NEUTRAL_VIOUT / SENSITIVITY },
+};
+
+// uDMA channel control table, which the hardware requires to be 1024 byte aligned
+static tDMAControlTable dma_control_table[64] __attribute__((aligned(1024)));
+
+// ping-pong buffers of interleaved passes, the uDMA fills one while the other is processed
+static uint16_t ping_buffer[BLOCK_SAMPLES];
+static uint16_t pong_buffer[BLOCK_SAMPLES];
+
+static AcquisitionBlockCallback block_callback = 0;
+static AcquisitionBlock latest_block;
+static volatile uint32_t block_count = 0;
+static uint32_t sample_rate = ACQUISITION_SAMPLE_RATE;
+
+/*
+ * Starts the ADC sampling hardware. Once every PWM0 generator 0 period
+ * sequence 0 converts each configured channel once, back to back, and the
+ * uDMA moves the results into the ping-pong buffers without involving the
+ * CPU.
+ */
+void StartADCSampling() {
+    int i;
+    uint32_t step_config;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC1);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_PWM0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+
+    // Sample clock, only the ADC trigger of the generator is used
+    PWMClockSet(PWM0_BASE, SAMPLE_PWM_CLOCK);
+    PWMGenConfigure(PWM0_BASE, PWM_GEN_0, PWM_GEN_MODE_DOWN | PWM_GEN_MODE_NO_SYNC);
+    SetAcquisitionSampleRate(sample_rate);
+    PWMGenIntTrigEnable(PWM0_BASE, PWM_GEN_0, PWM_TR_CMP_AD);
+
+    // One step per channel, each sample requests its own uDMA transfer
+    ADCSequenceConfigure(ADC1_BASE, SEQUENCE_NUMBER, ADC_TRIGGER_PWM0 | ADC_TRIGGER_PWM_MOD0, ADC_PRIORITY);
+    for (i = 0; i < ACQUISITION_CHANNELS; i++) {
+        GPIOPinTypeADC(channels[i].gpio_base, channels[i].gpio_pin);
+        step_config = channels[i].adc_channel | ADC_CTL_IE;
+        if (i == ACQUISITION_CHANNELS - 1) {
+            step_config |= ADC_CTL_END;
+        }
+        ADCSequenceStepConfigure(ADC1_BASE, SEQUENCE_NUMBER, i, step_config);
+    }
+
+    uDMAEnable();
+    uDMAControlBaseSet(dma_control_table);
+    uDMAChannelAssign(UDMA_CH24_ADC1_0);
+    uDMAChannelAttributeDisable(UDMA_SEC_CHANNEL_ADC10, UDMA_ATTR_ALTSELECT | UDMA_ATTR_HIGH_PRIORITY |
+                                UDMA_ATTR_REQMASK | UDMA_ATTR_USEBURST);
+    uDMAChannelControlSet(UDMA_SEC_CHANNEL_ADC10 | UDMA_PRI_SELECT,
+                          UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1);
+    uDMAChannelControlSet(UDMA_SEC_CHANNEL_ADC10 | UDMA_ALT_SELECT,
+                          UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1);
+    ArmBuffer(UDMA_PRI_SELECT, ping_buffer);
+    ArmBuffer(UDMA_ALT_SELECT, pong_buffer);
+    uDMAChannelEnable(UDMA_SEC_CHANNEL_ADC10);
+
+    // The sequence interrupt is raised when a buffer is full (INT_ADC1SS0, see app.cfg)
+    ADCSequenceDMAEnable(ADC1_BASE, SEQUENCE_NUMBER);
+    ADCIntClearEx(ADC1_BASE, ADC_INT_DMA_SS0);
+    ADCIntEnableEx(ADC1_BASE, ADC_INT_DMA_SS0);
+    ADCSequenceEnable(ADC1_BASE, SEQUENCE_NUMBER);
+
+    PWMGenEnable(PWM0_BASE, PWM_GEN_0);
+#ifdef MOTOR_PWM_MODULE
+    PWMSyncTimeBase(PWM0_BASE, PWM_GEN_0_BIT | MOTOR_PWM_GEN_BITS);
+#endif
+}
+
+/*
+ * Sets how many sequencer passes are taken per second. Each block of
+ * ACQUISITION_BLOCK_PASSES passes is decimated into a single value per channel.
+ */
+void SetAcquisitionSampleRate(uint32_t rate) {
+    uint32_t period;
+
+    if (rate < MIN_SAMPLE_RATE) {
+        rate = MIN_SAMPLE_RATE;
+    } else if (rate > MAX_SAMPLE_RATE) {
+        rate = MAX_SAMPLE_RATE;
+    }
+    period = SAMPLE_CLOCK_SPEED / rate;
+    // round to the nearest whole motor period, the rate reported follows
+    period = (period + MOTOR_PERIOD / 2) / MOTOR_PERIOD * MOTOR_PERIOD;
+    rate = SAMPLE_CLOCK_SPEED / period;
+    sample_rate = rate;
+    PWMGenPeriodSet(PWM0_BASE, PWM_GEN_0, period);
+    // compare A sits SAMPLE_LEAD clocks above the zero of the down count
+    PWMPulseWidthSet(PWM0_BASE, PWM_OUT_0, period - 1 - SAMPLE_LEAD);
+}
+
+/*
+ * Restarts the sample clock. Called straight after the motor timers are
+ * synchronised, with interrupts disabled, it puts the trigger back in step
+ * with the timers' on pulses. The PWM module generators are started together
+ * with it in StartADCSampling() instead.
+ */
+void SyncAcquisitionSampleClock() {
+    PWMSyncTimeBase(PWM0_BASE, PWM_GEN_0_BIT);
+}
+
+uint32_t GetAcquisitionSampleRate() {
+    return sample_rate;
+}
+
+/*
+ * Replaces the scaling of a channel, for example after calibrating the
+ * current sensor's zero point with the motor stopped.
+ */
+void SetAcquisitionCalibration(ACQUISITION_CHANNEL channel, float scale, float offset) {
+    channels[channel].scale = scale;
+    channels[channel].offset = offset;
+}
+
+/*
+ * Registers a function to be called, from the ADC interrupt, with each
+ * completed and decimated block.
+ */
+void SetAcquisitionBlockCallback(AcquisitionBlockCallback callback) {
+    block_callback = callback;
+}
+
+/*
+ * Gets the given channel's value from the most recently completed block.
+ */
+float GetAcquisitionValue(ACQUISITION_CHANNEL channel) {
+    return latest_block.value[channel];
+}
+
+/*
+ * Gets the motor current of the most recently completed block.
+ */
+double GetCurrentValue() {
+    return latest_block.value[CHANNEL_CURRENT];
+}
+
+/*
+ * Returns the number of sample blocks completed since sampling started.
+ */
+uint32_t GetAcquisitionBlockCount() {
+    return block_count;
+}
+
+/*
+ * Points one half of the ping-pong pair back at its buffer for another block.
+ */
+static void ArmBuffer(uint32_t select, uint16_t *buffer) {
+    uDMAChannelTransferSet(UDMA_SEC_CHANNEL_ADC10 | select, UDMA_MODE_PINGPONG,
+                           (void *)(ADC1_BASE + ADC_O_SSFIFO0), buffer, BLOCK_SAMPLES);
+}
+
+/*
+ * Averages each channel over a block of interleaved passes. The mean square
+ * current is taken per pass: heating goes with the mean of I^2, which the
+ * square of the mean current underestimates whenever it ripples.
+ */
+static void DecimateBlock(const uint16_t *samples, AcquisitionBlock *block) {
+    uint32_t sums[ACQUISITION_CHANNELS] = {0};
+    uint32_t twelve_bitmask = 0xfff;
+    const AcquisitionChannel *current = &channels[CHANNEL_CURRENT];
+    float square_sum = 0, amps;
+    uint16_t pass, i;
+
+    for (pass = 0; pass < ACQUISITION_BLOCK_PASSES; pass++) {
+        for (i = 0; i < ACQUISITION_CHANNELS; i++) {
+            sums[i] += samples[i] & twelve_bitmask;
+        }
+        amps = (samples[CHANNEL_CURRENT] & twelve_bitmask) * current->scale + current->offset;
+        square_sum += amps * amps;
+        samples += ACQUISITION_CHANNELS;
+    }
+
+    for (i = 0; i < ACQUISITION_CHANNELS; i++) {
+        block->value[i] = ((float)sums[i] / ACQUISITION_BLOCK_PASSES) * channels[i].scale + channels[i].offset;
+    }
+    block->current_mean_square = square_sum / ACQUISITION_BLOCK_PASSES;
+}
+
+/*
+ * ADC1 sequence 0 interrupt, raised each time the uDMA finishes filling one
+ * of the ping-pong buffers. The uDMA has already moved on to the other
+ * buffer, so the finished one can be processed and re-armed here.
+ */
+void AcquisitionADCIntHandler() {
+    uint16_t *buffer;
+    uint32_t select;
+
+    ADCIntClearEx(ADC1_BASE, ADC_INT_DMA_SS0);
+
+    if (uDMAChannelModeGet(UDMA_SEC_CHANNEL_ADC10 | UDMA_PRI_SELECT) == UDMA_MODE_STOP) {
+        buffer = ping_buffer;
+        select = UDMA_PRI_SELECT;
+    } else if (uDMAChannelModeGet(UDMA_SEC_CHANNEL_ADC10 | UDMA_ALT_SELECT) == UDMA_MODE_STOP) {
+        buffer = pong_buffer;
+        select = UDMA_ALT_SELECT;
+    } else {
+        return;
+    }
+
+    DecimateBlock(buffer, &latest_block);
+    block_count++;
+    if (block_callback) {
+        block_callback(&latest_block);
+    }
+    ArmBuffer(select, buffer);
+}
@@ -0,0 +1,36 @@
+#ifndef MOTOR_ACQUISITION_H_
+#define MOTOR_ACQUISITION_H_
+
+#include <stdint.h>
+
+#define ACQUISITION_SAMPLE_RATE 32000 // sequencer passes per second
+#define ACQUISITION_BLOCK_PASSES 8 // passes per ping-pong buffer, a block (and current loop update) every 0.25 ms
+
+// Channels sampled on every pass, in sequencer step order (at most 8). The DC
+// bus voltage (PE2, CH1) is left out until the motor board's sense divider is
+// known, and with it the electrical power.
+typedef enum ACQUISITION_CHANNEL {
+    CHANNEL_CURRENT = 0, // motor current, amps
+} ACQUISITION_CHANNEL;
+
+#define ACQUISITION_CHANNELS 1
+
+typedef struct AcquisitionBlock {
+    float value[ACQUISITION_CHANNELS]; // mean of each channel over the block, scaled
+    float current_mean_square; // mean of current^2 over the block, A^2
+} AcquisitionBlock;
+
+typedef void (*AcquisitionBlockCallback)(const AcquisitionBlock *block);
+
+void StartADCSampling();
+void SetAcquisitionSampleRate(uint32_t rate);
+uint32_t GetAcquisitionSampleRate();
+void SyncAcquisitionSampleClock();
+void SetAcquisitionCalibration(ACQUISITION_CHANNEL channel, float scale, float offset);
+void SetAcquisitionBlockCallback(AcquisitionBlockCallback callback);
+float GetAcquisitionValue(ACQUISITION_CHANNEL channel);
+double GetCurrentValue();
+uint32_t GetAcquisitionBlockCount();
+void AcquisitionADCIntHandler();
+
+#endif /* MOTOR_ACQUISITION_H_ */
@@ -0,0 +1,236 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include "autotune.h"
+#include "pi_control.h"
+#include "step_response.h"
+
+// Relay swing either side of the bias, in units of the speed PI output. That is
+// the current reference in amps with the cascaded current loop (0.05 A), and the
+// duty cycle with DIRECT_DUTY_LOOP in speed.c (5% duty).
+#define RELAY_AMPLITUDE PI_FROM_FLOAT(0.05)
+#define RELAY_HYSTERESIS 10 // RPM either side of the set point before the relay switches
+#define RELAY_CYCLES_IGNORED 2 // Oscillation takes a couple of cycles to become steady
+#define RELAY_CYCLES 4 // Cycles averaged for the ultimate gain and period
+#define RELAY_TIMEOUT 10000 // Give up if the relay has not finished after 10 seconds
+#define SETTLE_TICKS 2000 // Time spent at the lower speed before each test step
+#define STEP_TICKS 3000 // Time the test step response is watched for
+#define PI 3.14159265f
+
+/*
+ * Module variables.
+ */
+static volatile AUTOTUNE_STATE state = AUTOTUNE_IDLE;
+static int32_t tune_setpoint, bias_duty, relay_amplitude;
+static uint32_t ticks, last_switch_tick, period_sum;
+static int32_t speed_max, speed_min, swing_sum;
+static uint8_t cycles;
+static bool relay_high, gains_ready;
+static StepResponse step;
+static AutotuneReport report;
+
+/*
+ * Function Prototypes
+ */
+void AutotuneStart(int32_t setpoint);
+void AutotuneAbort();
+bool AutotuneIsRunning();
+AUTOTUNE_STATE GetAutotuneState();
+bool AutotuneUpdate(int32_t speed, int32_t *reference, int32_t *duty);
+bool AutotuneTakeGains(int32_t *kp, int32_t *ki);
+const AutotuneReport *GetAutotuneReport();
+static void ChangeState(AUTOTUNE_STATE next);
+static bool UpdateRelay(int32_t speed, int32_t *duty);
+static bool CalculateGains();
+
+/*
+ * Begins an autotune run around the given speed. The motor should already be
+ * running close to that speed. A step test is run with the current gains, then
+ * the relay experiment, then the same step test with the new gains.
+ */
+void AutotuneStart(int32_t setpoint) {
+    tune_setpoint = setpoint;
+    gains_ready = false;
+    ChangeState(AUTOTUNE_SETTLE_BEFORE);
+}
+
+void AutotuneAbort() {
+    if (AutotuneIsRunning()) {
+        ChangeState(AUTOTUNE_FAILED);
+    }
+}
+
+bool AutotuneIsRunning() {
+    return state != AUTOTUNE_IDLE && state != AUTOTUNE_DONE && state != AUTOTUNE_FAILED;
+}
+
+AUTOTUNE_STATE GetAutotuneState() {
+    return state;
+}
+
+/*
+ * Runs one control period of the autotune. Returns true when the relay is in
+ * charge and the speed PI output (duty cycle, or current reference when the
+ * loop is cascaded) should be set to *duty directly, which holds the present
+ * output on entry. Otherwise the PI loop should run as normal, following
+ * *reference instead of the ramp.
+ */
+bool AutotuneUpdate(int32_t speed, int32_t *reference, int32_t *duty) {
+    ++ticks;
+
+    switch (state) {
+        case AUTOTUNE_SETTLE_BEFORE:
+        case AUTOTUNE_SETTLE_AFTER:
+            // Test steps go from 3/4 of the set point up to the set point
+            *reference = (tune_setpoint * 3) / 4;
+            if (ticks >= SETTLE_TICKS) {
+                StepResponseStart(&step, speed, tune_setpoint);
+                ChangeState(state == AUTOTUNE_SETTLE_BEFORE ? AUTOTUNE_STEP_BEFORE : AUTOTUNE_STEP_AFTER);
+            }
+            return false;
+        case AUTOTUNE_STEP_BEFORE:
+            *reference = tune_setpoint;
+            StepResponseUpdate(&step, speed);
+            if (ticks >= STEP_TICKS) {
+                report.rise_before = StepResponseRiseTime(&step);
+                report.overshoot_before = StepResponseOvershoot(&step);
+                bias_duty = *duty;
+                ChangeState(AUTOTUNE_RELAY);
+            }
+            return false;
+        case AUTOTUNE_RELAY:
+            *reference = tune_setpoint;
+            return UpdateRelay(speed, duty);
+        case AUTOTUNE_STEP_AFTER:
+            *reference = tune_setpoint;
+            StepResponseUpdate(&step, speed);
+            if (ticks >= STEP_TICKS) {
+                report.rise_after = StepResponseRiseTime(&step);
+                report.overshoot_after = StepResponseOvershoot(&step);
+                ChangeState(AUTOTUNE_DONE);
+                System_printf("autotune: kp %d ki %d (Q24), rise %d -> %d ms, overshoot %d -> %d %%\n",
+                              report.kp, report.ki, report.rise_before, report.rise_after,
+                              report.overshoot_before, report.overshoot_after);
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Hands over newly calculated gains once, returning false if there are none waiting.
+ */
+bool AutotuneTakeGains(int32_t *kp, int32_t *ki) {
+    if (!gains_ready) {
+        return false;
+    }
+
+    gains_ready = false;
+    *kp = report.kp;
+    *ki = report.ki;
+    return true;
+}
+
+const AutotuneReport *GetAutotuneReport() {
+    return &report;
+}
+
+static void ChangeState(AUTOTUNE_STATE next) {
+    ticks = 0;
+
+    if (next == AUTOTUNE_RELAY) {
+        relay_amplitude = RELAY_AMPLITUDE;
+        if (relay_amplitude > bias_duty) {
+            relay_amplitude = bias_duty;
+        }
+
+        relay_high = false;
+        cycles = 0;
+        last_switch_tick = 0;
+        period_sum = 0;
+        swing_sum = 0;
+        speed_max = INT32_MIN;
+        speed_min = INT32_MAX;
+    }
+
+    state = next;
+}
+
+/*
+ * Bang-bang relay with hysteresis around the set point, as in the Astrom-Hagglund
+ * method. Each time the relay switches high a full oscillation has been seen, and
+ * once enough have been timed the PI gains are calculated from them.
+ */
+static bool UpdateRelay(int32_t speed, int32_t *duty) {
+    if (speed > speed_max) {
+        speed_max = speed;
+    }
+
+    if (speed < speed_min) {
+        speed_min = speed;
+    }
+
+    if (relay_high && speed > tune_setpoint + RELAY_HYSTERESIS) {
+        relay_high = false;
+    } else if (!relay_high && speed < tune_setpoint - RELAY_HYSTERESIS) {
+        relay_high = true;
+
+        if (cycles >= RELAY_CYCLES_IGNORED) {
+            period_sum += ticks - last_switch_tick;
+            swing_sum += speed_max - speed_min;
+        }
+
+        ++cycles;
+        last_switch_tick = ticks;
+        speed_max = INT32_MIN;
+        speed_min = INT32_MAX;
+
+        if (cycles >= RELAY_CYCLES_IGNORED + RELAY_CYCLES) {
+            ChangeState(CalculateGains() ? AUTOTUNE_SETTLE_AFTER : AUTOTUNE_FAILED);
+            return false;
+        }
+    }
+
+    if (ticks >= RELAY_TIMEOUT) {
+        ChangeState(AUTOTUNE_FAILED);
+        return false;
+    }
+
+    *duty = relay_high ? bias_duty + relay_amplitude : bias_duty - relay_amplitude;
+    return true;
+}
+
+/*
+ * Works out the ultimate gain and period from the relay oscillation and turns them
+ * into PI gains with the Ziegler-Nichols rules (Kp = 0.45 Ku, Ti = Tu / 1.2).
+ */
+static bool CalculateGains() {
+    float amplitude, ultimate_gain, kp, integral_time;
+
+    report.ultimate_period = period_sum / RELAY_CYCLES;
+    report.oscillation_amplitude = swing_sum / (2 * RELAY_CYCLES);
+    report.relay_amplitude = relay_amplitude;
+    amplitude = report.oscillation_amplitude;
+
+    if (amplitude <= RELAY_HYSTERESIS || report.ultimate_period == 0) {
+        return false;
+    }
+
+    // Describing function of a relay with hysteresis
+    ultimate_gain = (4.0f * relay_amplitude / PI_ONE) /
+                    (PI * sqrtf(amplitude * amplitude - RELAY_HYSTERESIS * RELAY_HYSTERESIS));
+    kp = 0.45f * ultimate_gain;
+    integral_time = report.ultimate_period / 1.2f;
+
+    report.kp = PI_FROM_FLOAT(kp);
+    report.ki = PI_FROM_FLOAT(kp / integral_time);
+    if (report.ki == 0) {
+        report.ki = 1;
+    }
+
+    gains_ready = true;
+    return true;
+}
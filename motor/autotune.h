@@ -0,0 +1,42 @@
+#ifndef MOTOR_AUTOTUNE_H_
+#define MOTOR_AUTOTUNE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum AUTOTUNE_STATE {
+    AUTOTUNE_IDLE,
+    AUTOTUNE_SETTLE_BEFORE,
+    AUTOTUNE_STEP_BEFORE,
+    AUTOTUNE_RELAY,
+    AUTOTUNE_SETTLE_AFTER,
+    AUTOTUNE_STEP_AFTER,
+    AUTOTUNE_DONE,
+    AUTOTUNE_FAILED,
+} AUTOTUNE_STATE;
+
+/*
+ * Outcome of the last autotune run. Gains are PI_Q fixed point, times are in
+ * control updates (milliseconds) and overshoot is a percentage of the test step.
+ */
+typedef struct AutotuneReport {
+    int32_t kp;
+    int32_t ki;
+    int32_t relay_amplitude;
+    int32_t oscillation_amplitude; // Half the peak to peak speed swing, in RPM
+    uint32_t ultimate_period;
+    uint32_t rise_before;
+    uint32_t rise_after;
+    int32_t overshoot_before;
+    int32_t overshoot_after;
+} AutotuneReport;
+
+void AutotuneStart(int32_t setpoint);
+void AutotuneAbort();
+bool AutotuneIsRunning();
+AUTOTUNE_STATE GetAutotuneState();
+bool AutotuneUpdate(int32_t speed, int32_t *reference, int32_t *duty);
+bool AutotuneTakeGains(int32_t *kp, int32_t *ki);
+const AutotuneReport *GetAutotuneReport();
+
+#endif /* MOTOR_AUTOTUNE_H_ */
@@ -0,0 +1,240 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include "benchmark.h"
+#include "pi_control.h"
+#include "step_response.h"
+#include "timing.h"
+
+/*
+ * Scripted set point scenario, run through the normal ramp and PI loop so
+ * the results cover the whole speed control path.
+ */
+typedef struct BenchmarkStep {
+    int32_t speed;     // RPM
+    uint32_t duration; // Control updates (milliseconds) to hold the set point for
+} BenchmarkStep;
+
+static const BenchmarkStep SCENARIO[] = {
+    {300, 4000},
+    {800, 4000},
+    {500, 4000},
+    {1000, 5000},
+    {200, 5000},
+};
+
+#define SCENARIO_STEPS (sizeof(SCENARIO) / sizeof(SCENARIO[0]))
+
+// The fixed point controller is timed with the direct duty speed loop's gains
+// and limits, the double one with the constants it had in speed.c
+#define FIXED_KP PI_FROM_FLOAT(0.00003)
+#define FIXED_KI PI_FROM_FLOAT(0.0000003)
+#define FIXED_MAX_DUTY PI_FROM_FLOAT(0.95)
+#define FIXED_MAX_INCREMENT PI_FROM_FLOAT(0.0005)
+#define DOUBLE_MAX_INCREMENT 0.00001
+#define DOUBLE_KP (DOUBLE_MAX_INCREMENT / 100)
+#define DOUBLE_KI (DOUBLE_KP / 100)
+#define DOUBLE_MAX_ERROR_SUM 10
+#define DOUBLE_MAX_DUTY 0.95
+
+/*
+ * Module variables.
+ */
+static volatile bool running = false, done = false;
+static uint8_t step_index;
+static int32_t original_setpoint;
+static uint32_t ticks, loop_cycle_count, timing_overhead;
+static uint64_t loop_cycle_sum, fixed_cycle_sum, double_cycle_sum;
+static PIController fixed_pi;
+static double double_error_sum, double_duty;
+static StepResponse response;
+static BenchmarkReport report;
+
+/*
+ * Function Prototypes
+ */
+bool BenchmarkStart(int32_t setpoint);
+void BenchmarkAbort();
+bool BenchmarkIsRunning();
+bool BenchmarkIsDone();
+bool BenchmarkUpdate(int32_t speed, uint32_t loop_cycles, int32_t *setpoint);
+const BenchmarkReport *GetBenchmarkReport();
+static void FinishStep();
+static void TimeControllers(int32_t error);
+static void DoublePIUpdate(double error);
+static void PrintReport();
+
+/*
+ * Starts running the scenario. The given set point is restored at the end.
+ */
+bool BenchmarkStart(int32_t setpoint) {
+    uint32_t start;
+
+    if (running) {
+        return false;
+    }
+
+    original_setpoint = setpoint;
+    step_index = 0;
+    ticks = 0;
+    loop_cycle_sum = 0;
+    loop_cycle_count = 0;
+    fixed_cycle_sum = 0;
+    double_cycle_sum = 0;
+    report.step_count = 0;
+    report.max_loop_cycles = 0;
+    report.mean_loop_cycles = 0;
+    report.fixed_pi_cycles = 0;
+    report.double_pi_cycles = 0;
+
+    PIControllerInit(&fixed_pi, FIXED_KP, FIXED_KI, 0, FIXED_MAX_DUTY);
+    PIControllerSetLimits(&fixed_pi, 0, FIXED_MAX_DUTY, FIXED_MAX_DUTY, FIXED_MAX_INCREMENT);
+    double_error_sum = 0;
+    double_duty = 0;
+    start = TimingNow();
+    timing_overhead = TimingElapsed(start);
+    done = false;
+    running = true;
+    return true;
+}
+
+void BenchmarkAbort() {
+    running = false;
+}
+
+bool BenchmarkIsRunning() {
+    return running;
+}
+
+bool BenchmarkIsDone() {
+    return done;
+}
+
+/*
+ * Runs one control period of the scenario, given the measured speed and the CPU
+ * cycles the last control update took. Returns true when the set point needs to
+ * change to *setpoint.
+ */
+bool BenchmarkUpdate(int32_t speed, uint32_t loop_cycles, int32_t *setpoint) {
+    if (!running) {
+        return false;
+    }
+
+    loop_cycle_sum += loop_cycles;
+    ++loop_cycle_count;
+    if (loop_cycles > report.max_loop_cycles) {
+        report.max_loop_cycles = loop_cycles;
+    }
+
+    if (ticks == 0) {
+        StepResponseStart(&response, speed, SCENARIO[step_index].speed);
+        *setpoint = SCENARIO[step_index].speed;
+        ++ticks;
+        return true;
+    }
+
+    StepResponseUpdate(&response, speed);
+    TimeControllers(SCENARIO[step_index].speed - speed);
+    ++ticks;
+    if (ticks <= SCENARIO[step_index].duration) {
+        return false;
+    }
+
+    FinishStep();
+    ticks = 0;
+    ++step_index;
+    if (step_index < SCENARIO_STEPS) {
+        return false;
+    }
+
+    report.mean_loop_cycles = loop_cycle_sum / loop_cycle_count;
+    report.fixed_pi_cycles = fixed_cycle_sum / loop_cycle_count;
+    report.double_pi_cycles = double_cycle_sum / loop_cycle_count;
+    running = false;
+    done = true;
+    PrintReport();
+    *setpoint = original_setpoint;
+    return true;
+}
+
+const BenchmarkReport *GetBenchmarkReport() {
+    return &report;
+}
+
+static void FinishStep() {
+    BenchmarkResult *result;
+
+    if (report.step_count >= BENCHMARK_MAX_STEPS) {
+        return;
+    }
+
+    result = &report.steps[report.step_count++];
+    result->target = response.target;
+    result->rise_time = StepResponseRiseTime(&response);
+    result->settling_time = StepResponseSettlingTime(&response);
+    result->overshoot = StepResponseOvershoot(&response);
+    result->steady_state_error = StepResponseSteadyStateError(&response);
+}
+
+/*
+ * Runs the fixed point controller and the double precision one it replaced on
+ * the same speed error, timing each with the cycle counter. Neither drives the
+ * motor. The cost of reading the counter is taken off.
+ */
+static void TimeControllers(int32_t error) {
+    uint32_t start, cycles;
+
+    start = TimingNow();
+    PIControllerUpdate(&fixed_pi, error);
+    cycles = TimingElapsed(start);
+    fixed_cycle_sum += cycles > timing_overhead ? cycles - timing_overhead : 0;
+
+    start = TimingNow();
+    DoublePIUpdate(error);
+    cycles = TimingElapsed(start);
+    double_cycle_sum += cycles > timing_overhead ? cycles - timing_overhead : 0;
+}
+
+/*
+ * The speed PI as it was before pi_control.c, in double precision, which the
+ * M4F's single precision FPU runs through library calls.
+ */
+static void DoublePIUpdate(double error) {
+    double duty_inc;
+
+    double_error_sum += error;
+    duty_inc = DOUBLE_KP * error + DOUBLE_KI * double_error_sum;
+    if (double_error_sum >= DOUBLE_MAX_ERROR_SUM) {
+        double_error_sum = DOUBLE_MAX_ERROR_SUM;
+    }
+    if (duty_inc >= DOUBLE_MAX_INCREMENT) {
+        duty_inc = DOUBLE_MAX_INCREMENT;
+    } else if (duty_inc <= -DOUBLE_MAX_INCREMENT) {
+        duty_inc = -DOUBLE_MAX_INCREMENT;
+    }
+    double_duty += duty_inc;
+    if (double_duty >= DOUBLE_MAX_DUTY) {
+        double_duty = DOUBLE_MAX_DUTY;
+    }
+}
+
+/*
+ * Dumps the results to the SysMin buffer (view with ROV) so runs can be compared.
+ */
+static void PrintReport() {
+    uint8_t i;
+    BenchmarkResult *result;
+
+    for (i = 0; i < report.step_count; i++) {
+        result = &report.steps[i];
+        System_printf("benchmark: %d rpm rise %d ms settle %d ms overshoot %d %% error %d rpm\n",
+                      result->target, result->rise_time, result->settling_time,
+                      result->overshoot, result->steady_state_error);
+    }
+
+    System_printf("benchmark: loop %d cycles mean, %d max\n",
+                  report.mean_loop_cycles, report.max_loop_cycles);
+    System_printf("benchmark: PI update %d cycles fixed point, %d cycles double\n",
+                  report.fixed_pi_cycles, report.double_pi_cycles);
+}
@@ -0,0 +1,38 @@
+#ifndef MOTOR_BENCHMARK_H_
+#define MOTOR_BENCHMARK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BENCHMARK_MAX_STEPS 8
+
+/*
+ * Closed loop performance for one set point step of the scenario. Times are in
+ * control updates (milliseconds), overshoot is a percentage of the step and the
+ * steady state error is in RPM.
+ */
+typedef struct BenchmarkResult {
+    int32_t target;
+    uint32_t rise_time;
+    uint32_t settling_time; // 0 if the speed never settled within the step
+    int32_t overshoot;
+    int32_t steady_state_error;
+} BenchmarkResult;
+
+typedef struct BenchmarkReport {
+    uint8_t step_count;
+    BenchmarkResult steps[BENCHMARK_MAX_STEPS];
+    uint32_t max_loop_cycles;
+    uint32_t mean_loop_cycles;
+    uint32_t fixed_pi_cycles;  // mean of one PIControllerUpdate() on the step's error
+    uint32_t double_pi_cycles; // mean of the double precision controller it replaced
+} BenchmarkReport;
+
+bool BenchmarkStart(int32_t setpoint);
+void BenchmarkAbort();
+bool BenchmarkIsRunning();
+bool BenchmarkIsDone();
+bool BenchmarkUpdate(int32_t speed, uint32_t loop_cycles, int32_t *setpoint);
+const BenchmarkReport *GetBenchmarkReport();
+
+#endif /* MOTOR_BENCHMARK_H_ */
@@ -1,7 +0,0 @@
-#ifndef MOTOR_CURRENT_H_
-#define MOTOR_CURRENT_H_
-
-void StartADCSampling();
-double GetCurrentValue();
-
-#endif /* MOTOR_CURRENT_H_ */
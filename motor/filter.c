@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include "filter.h"
+
+/*
+ * Function Prototypes
+ */
+void MovingAverageInit(MovingAverage *filter, uint8_t window);
+void MovingAverageSetWindow(MovingAverage *filter, uint8_t window);
+float MovingAverageUpdate(MovingAverage *filter, float sample);
+void LowPassInit(LowPassFilter *filter, float alpha);
+void LowPassSetAlpha(LowPassFilter *filter, float alpha);
+float LowPassUpdate(LowPassFilter *filter, float sample);
+void MedianInit(MedianFilter *filter, uint8_t window);
+void MedianSetWindow(MedianFilter *filter, uint8_t window);
+float MedianUpdate(MedianFilter *filter, float sample);
+
+void MovingAverageInit(MovingAverage *filter, uint8_t window) {
+    filter->output = 0;
+    MovingAverageSetWindow(filter, window);
+}
+
+/*
+ * Changes the number of samples averaged. The filter starts over, averaging
+ * whatever samples it has until the new window fills up.
+ */
+void MovingAverageSetWindow(MovingAverage *filter, uint8_t window) {
+    if (window < 1) {
+        window = 1;
+    } else if (window > FILTER_MAX_WINDOW) {
+        window = FILTER_MAX_WINDOW;
+    }
+    filter->window = window;
+    filter->index = 0;
+    filter->count = 0;
+    filter->sum = 0;
+}
+
+/*
+ * Adds a sample and returns the new average.
+ */
+float MovingAverageUpdate(MovingAverage *filter, float sample) {
+    uint8_t i;
+
+    if (filter->count < filter->window) {
+        filter->count++;
+    } else {
+        filter->sum -= filter->samples[filter->index];
+    }
+    filter->samples[filter->index] = sample;
+    filter->sum += sample;
+
+    if (++filter->index >= filter->window) {
+        filter->index = 0;
+        filter->sum = 0;
+        for (i = 0; i < filter->count; i++) {
+            filter->sum += filter->samples[i];
+        }
+    }
+
+    filter->output = filter->sum / filter->count;
+    return filter->output;
+}
+
+void LowPassInit(LowPassFilter *filter, float alpha) {
+    LowPassSetAlpha(filter, alpha);
+    filter->output = 0;
+    filter->primed = 0;
+}
+
+/*
+ * Sets how much of each new sample is let through, from 0 (output never moves)
+ * to 1 (no filtering).
+ */
+void LowPassSetAlpha(LowPassFilter *filter, float alpha) {
+    if (alpha < 0) {
+        alpha = 0;
+    } else if (alpha > 1) {
+        alpha = 1;
+    }
+    filter->alpha = alpha;
+}
+
+float LowPassUpdate(LowPassFilter *filter, float sample) {
+    if (!filter->primed) {
+        filter->output = sample;
+        filter->primed = 1;
+    } else {
+        filter->output += filter->alpha * (sample - filter->output);
+    }
+    return filter->output;
+}
+
+void MedianInit(MedianFilter *filter, uint8_t window) {
+    filter->output = 0;
+    MedianSetWindow(filter, window);
+}
+
+/*
+ * Changes the number of samples the median is taken over. Odd windows give a
+ * true median, even windows the upper of the middle pair.
+ */
+void MedianSetWindow(MedianFilter *filter, uint8_t window) {
+    if (window < 1) {
+        window = 1;
+    } else if (window > FILTER_MAX_MEDIAN) {
+        window = FILTER_MAX_MEDIAN;
+    }
+    filter->window = window;
+    filter->index = 0;
+    filter->count = 0;
+}
+
+/*
+ * Adds a sample and returns the median of the window. The sample leaving the
+ * window is found in the sorted copy and the new one is shifted into its slot
+ * from there, so an update walks the sorted window at most twice.
+ */
+float MedianUpdate(MedianFilter *filter, float sample) {
+    float *sorted = filter->sorted;
+    float oldest = filter->samples[filter->index];
+    int8_t i, last;
+
+    // the slot freed up: the end while the window fills, then the oldest sample's
+    if (filter->count < filter->window) {
+        i = filter->count++;
+    } else {
+        for (i = 0; i < filter->count - 1 && sorted[i] != oldest; i++) {
+        }
+    }
+    last = filter->count - 1;
+
+    // move the slot down or up to where the new sample belongs
+    while (i > 0 && sorted[i - 1] > sample) {
+        sorted[i] = sorted[i - 1];
+        i--;
+    }
+    while (i < last && sorted[i + 1] < sample) {
+        sorted[i] = sorted[i + 1];
+        i++;
+    }
+    sorted[i] = sample;
+
+    filter->samples[filter->index] = sample;
+    if (++filter->index >= filter->window) {
+        filter->index = 0;
+    }
+
+    filter->output = sorted[filter->count / 2];
+    return filter->output;
+}
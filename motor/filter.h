@@ -0,0 +1,58 @@
+#ifndef MOTOR_FILTER_H_
+#define MOTOR_FILTER_H_
+
+#include <stdint.h>
+
+#define FILTER_MAX_WINDOW 32 // largest moving average window
+#define FILTER_MAX_MEDIAN 7 // largest median window, kept small as each update shifts it
+
+/*
+ * Moving average over the last window samples. A running sum makes each update
+ * O(1); the sum is recomputed from the buffer whenever the window wraps so
+ * float rounding can't build up.
+ */
+typedef struct MovingAverage {
+    float samples[FILTER_MAX_WINDOW];
+    uint8_t window;
+    uint8_t index;
+    uint8_t count;
+    float sum;
+    float output;
+} MovingAverage;
+
+/*
+ * First order low pass, output += alpha * (input - output).
+ */
+typedef struct LowPassFilter {
+    float alpha;
+    float output;
+    uint8_t primed; // the first sample is taken as is
+} LowPassFilter;
+
+/*
+ * Median of the last window samples, to throw away single sample spikes. A
+ * sorted copy of the window is kept alongside the samples in arrival order,
+ * so each update is one O(window) remove and insert instead of a sort.
+ */
+typedef struct MedianFilter {
+    float samples[FILTER_MAX_MEDIAN]; // in arrival order
+    float sorted[FILTER_MAX_MEDIAN]; // the same samples, ascending
+    uint8_t window;
+    uint8_t index;
+    uint8_t count;
+    float output;
+} MedianFilter;
+
+void MovingAverageInit(MovingAverage *filter, uint8_t window);
+void MovingAverageSetWindow(MovingAverage *filter, uint8_t window);
+float MovingAverageUpdate(MovingAverage *filter, float sample);
+
+void LowPassInit(LowPassFilter *filter, float alpha);
+void LowPassSetAlpha(LowPassFilter *filter, float alpha);
+float LowPassUpdate(LowPassFilter *filter, float sample);
+
+void MedianInit(MedianFilter *filter, uint8_t window);
+void MedianSetWindow(MedianFilter *filter, uint8_t window);
+float MedianUpdate(MedianFilter *filter, float sample);
+
+#endif /* MOTOR_FILTER_H_ */
@@ -1,130 +1,139 @@
-#include <stdint.h>
-#include <stdbool.h>
-#include <ti/sysbios/BIOS.h>
-#include <ti/sysbios/knl/Semaphore.h>
-#include "speed.h"
-#include "current.h"
-#include "temperature.h"
-
-#define MIN_TA_ALLOWED -40 // For motor to work according to its datasheet
-#define MAX_TA_ALLOWED 85
-#define LOW_TEMP_LIMIT -20 // Minimum temperature that can be detected for object
-#define UPPER_TEMP_LIMIT 200 // Maximum temperature that can be detected for object
-#define SPEED_SAMPLES 5
-#define CURRENT_SAMPLES 5
-#define TEMPERATURE_SAMPLES 3
-
-void MeasurementInit();
-void TakeMeasurements();
-void MeasureTemperature();
-double GetFilteredSpeed();
-double GetFilteredTemperature();
-double GetFilteredCurrentValue();
-
-static uint8_t Ps = 0, Pt = 0, Pc = 0; // keep track of the next value to be modified
-static int measurement_counter = 0;
-static double recent_speeds[SPEED_SAMPLES];
-static double recent_temperatures[TEMPERATURE_SAMPLES];
-static double recent_currents[CURRENT_SAMPLES];
-
-// NOTE: TIMERS 0, 2 and 3 ARE BEING USED AS PWM OUTPUTS.
-// HENCE, DO NOT USE THEM AT ALL FOR FILTERING HERE.
-
-void MeasurementInit() {
-    int i = 0;
-
-    for (i = 0; i < SPEED_SAMPLES; i++) {
-        recent_speeds[i] = 0;
-    }
-
-    for (i = 0; i < CURRENT_SAMPLES; i++) {
-        recent_currents[i] = 0;
-    }
-
-    for (i = 0; i < TEMPERATURE_SAMPLES; i++) {
-        recent_temperatures[i] = 0;
-    }
-}
-
-/*
- *  Starts the process of sampling motor current and speed readings.
- *
- *  Outputs: 0 if the process is properly ended, -1 if a fault has occured.
- */
-void TakeMeasurements() {
-    recent_speeds[Ps] = GetMotorSpeed();
-    recent_currents[Pc] = GetCurrentValue();
-
-    // Move to next array element for overwriting value
-    ++Ps;
-    ++Pc;
-
-    // Ensure pointer value moves back to start of array once it reaches end
-    if (Ps > SPEED_SAMPLES-1) {
-        Ps = 0;
-    }
-
-    if (Pc > CURRENT_SAMPLES-1) {
-        Pc = 0;
-    }
-}
-
-void MeasureTemperature() {
-    recent_temperatures[Pt] = GetTemperature();
-    ++Pt;
-
-    if (Pt > TEMPERATURE_SAMPLES-1) {
-        Pt = 0;
-    }
-}
-
-/*
- * Collects 6 samples of motor speed per 6 milliseconds interval
- * (single sample is collected by calling GetMotorSpeed() function
- * but for now, just make a random sample value for testing purposes)
- * and then uses those samples to return an averaged sample value.
- */
-double GetFilteredSpeed() {
-    uint8_t i = 0;
-    double sum = 0;
-
-    for (i = 0; i < SPEED_SAMPLES; i++) {
-        sum += recent_speeds[i];
-    }
-
-    return (sum / SPEED_SAMPLES);
-}
-
-/*
- * Collects 3 samples of motor temperature per 1.5 seconds interval
- * (single sample is collected by calling GetTemperature() function
- * but for now, just make a random sample value for testing purposes)
- * and then uses those samples to return an averaged sample value.
- */
-double GetFilteredTemperature() {
-    uint8_t i = 0;
-    double sum = 0;
-
-    for (i = 0; i < TEMPERATURE_SAMPLES; i++) {
-        sum += recent_temperatures[i];
-    }
-
-    return (sum / TEMPERATURE_SAMPLES);
-}
-
-/*
- * Collects 5 samples of motor temperature per 5 millisecond intervals
- * (single sample is collected by calling GetCurrentValue() function
- * but for now, just make a random sample value for testing purposes)
- * and then uses those samples to return an averaged sample value.
- */
-double GetFilteredCurrentValue() {
-    uint8_t i = 0;
-    double sum = 0;
-
-    for (i = 0; i < CURRENT_SAMPLES; i++) {
-        sum += recent_currents[i];
-    }
-
-    return (sum / CURRENT_SAMPLES);
-}
+#include <stdint.h>
+#include <stdbool.h>
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include "speed.h"
+#include "acquisition.h"
+#include "temperature.h"
+#include "filter.h"
+#include "thermal.h"
+
+#define MIN_TA_ALLOWED -40 // For motor to work according to its datasheet
+#define MAX_TA_ALLOWED 85
+#define LOW_TEMP_LIMIT -20 // Minimum temperature that can be detected for object
+#define UPPER_TEMP_LIMIT 200 // Maximum temperature that can be detected for object
+
+// default filter windows, all of them can be changed at runtime
+#define SPEED_WINDOW 5 // 5 ms of 1 ms speed samples
+#define CURRENT_WINDOW 20 // 5 ms of 0.25 ms current blocks
+#define TEMPERATURE_MEDIAN 3 // throws away a single bad sensor read
+#define TEMPERATURE_WINDOW 3
+
+void MeasurementInit();
+void TakeMeasurements();
+void MeasureTemperature();
+double GetFilteredSpeed();
+double GetFilteredTemperature();
+double GetFilteredCurrentValue();
+void SetSpeedFilterWindow(uint8_t window);
+void SetCurrentFilterWindow(uint8_t window);
+void SetTemperatureFilterWindow(uint8_t median, uint8_t window);
+static void StoreAcquisitionBlock(const AcquisitionBlock *block);
+
+static MovingAverage speed_filter;
+static MovingAverage current_filter; // updated from the ADC interrupt
+static MedianFilter temperature_spikes;
+static MovingAverage temperature_filter;
+static bool temperature_seen = false;
+
+// NOTE: TIMERS 0, 2 and 3 ARE BEING USED AS PWM OUTPUTS.
+// HENCE, DO NOT USE THEM AT ALL FOR FILTERING HERE.
+
+void MeasurementInit() {
+    MovingAverageInit(&speed_filter, SPEED_WINDOW);
+    MovingAverageInit(&current_filter, CURRENT_WINDOW);
+    MedianInit(&temperature_spikes, TEMPERATURE_MEDIAN);
+    MovingAverageInit(&temperature_filter, TEMPERATURE_WINDOW);
+
+    SetAcquisitionBlockCallback(StoreAcquisitionBlock);
+}
+
+/*
+ *  Samples the motor speed. Current arrives separately, one decimated value
+ *  per ADC block, through StoreAcquisitionBlock.
+ */
+void TakeMeasurements() {
+    MovingAverageUpdate(&speed_filter, GetMotorSpeed());
+}
+
+/*
+ *  Called from the ADC interrupt with each completed acquisition block. Runs
+ *  the inner current loop, keeps the block's average current and runs the
+ *  thermal model forward by the block's length.
+ */
+static void StoreAcquisitionBlock(const AcquisitionBlock *block) {
+    float current = block->value[CHANNEL_CURRENT];
+
+    CurrentControl(current);
+    MovingAverageUpdate(&current_filter, current);
+    ThermalModelUpdate(block->current_mean_square, (float)ACQUISITION_BLOCK_PASSES / GetAcquisitionSampleRate());
+}
+
+/*
+ *  Reads the temperature sensor and stores the reading once the sensor has a
+ *  new one. Blocks the calling task while the I2C transfers complete, so it
+ *  must only be called from the thermal task.
+ */
+void MeasureTemperature() {
+    float temperature;
+
+    if (!UpdateTemperature()) {
+        return;
+    }
+
+    temperature = MedianUpdate(&temperature_spikes, GetTemperature());
+    MovingAverageUpdate(&temperature_filter, temperature);
+
+    // the thermal model predicts between readings, each reading corrects it
+    if (!temperature_seen) {
+        ThermalModelInit(temperature);
+        temperature_seen = true;
+    } else {
+        ThermalModelCorrect(temperature);
+    }
+}
+
+/*
+ * Returns the average of the most recent motor speed samples, one taken
+ * per millisecond. The average is kept up to date as samples arrive, so
+ * this is cheap to call as often as needed.
+ */
+double GetFilteredSpeed() {
+    return speed_filter.output;
+}
+
+/*
+ * Returns the average of the most recent motor temperature readings,
+ * after single reading spikes have been removed by a median.
+ */
+double GetFilteredTemperature() {
+    return temperature_filter.output;
+}
+
+/*
+ * Returns the average of the most recent current blocks, each itself the
+ * mean of ACQUISITION_BLOCK_PASSES ADC samples.
+ */
+double GetFilteredCurrentValue() {
+    return current_filter.output;
+}
+
+void SetSpeedFilterWindow(uint8_t window) {
+    UInt key = Hwi_disable();
+    MovingAverageSetWindow(&speed_filter, window);
+    Hwi_restore(key);
+}
+
+void SetCurrentFilterWindow(uint8_t window) {
+    UInt key = Hwi_disable();
+    MovingAverageSetWindow(&current_filter, window);
+    Hwi_restore(key);
+}
+
+void SetTemperatureFilterWindow(uint8_t median, uint8_t window) {
+    UInt key = Hwi_disable();
+    MedianSetWindow(&temperature_spikes, median);
+    MovingAverageSetWindow(&temperature_filter, window);
+    Hwi_restore(key);
+}
@@ -1,11 +1,16 @@
-#ifndef MOTOR_MEASUREMENT_H_
-#define MOTOR_MEASUREMENT_H_
-
-void MeasurementInit();
-void TakeMeasurements();
-void MeasureTemperature();
-double GetFilteredSpeed();
-double GetFilteredTemperature();
-double GetFilteredCurrentValue();
-
-#endif /* MOTOR_MEASUREMENT_H_ */
+#ifndef MOTOR_MEASUREMENT_H_
+#define MOTOR_MEASUREMENT_H_
+
+#include <stdint.h>
+
+void MeasurementInit();
+void TakeMeasurements();
+void MeasureTemperature();
+double GetFilteredSpeed();
+double GetFilteredTemperature();
+double GetFilteredCurrentValue();
+void SetSpeedFilterWindow(uint8_t window);
+void SetCurrentFilterWindow(uint8_t window);
+void SetTemperatureFilterWindow(uint8_t median, uint8_t window);
+
+#endif /* MOTOR_MEASUREMENT_H_ */
@@ -1,69 +1,141 @@
-
-#include <stdint.h>
-#include <stdio.h>
-#include <stdbool.h>
-#include "inc/hw_memmap.h"
-#include "driverlib/timer.h"
-#include "driverlib/gpio.h"
-
-#include "motorLib.h"
-
-
-void resetLines(uint8_t val_a, uint8_t val_b, uint8_t val_c)
-{
-    GPIOPinWrite(EGH456_RESET_A, val_a);
-    GPIOPinWrite(EGH456_RESET_B, val_b);
-    GPIOPinWrite(EGH456_RESET_C, val_c);
-}
-
-void pwmSet(uint32_t timer_base, uint32_t timer, int32_t pwm_val)
-{
-//    uint32_t pwm_val = 999 * pwm_percent / 100;
-    TimerMatchSet(timer_base, timer, pwm_val);
-}
-
-
-void driveMotor(uint8_t phase, int32_t pwm_val)
-{
-    switch(phase)
-        {
-
-        case PHASE_001:
-            resetLines(0xff, 0, 0xff);
-            pwmSet(MOTOR_A_TIMER, pwm_val);
-            pwmSet(MOTOR_C_TIMER, 0.f);
-            break;
-
-        case PHASE_010:
-            resetLines(0xff, 0xff, 0);
-            pwmSet(MOTOR_B_TIMER, pwm_val);
-            pwmSet(MOTOR_A_TIMER, 0.f);
-            break;
-
-        case PHASE_011:
-            resetLines(0, 0xff, 0xff);
-            pwmSet(MOTOR_B_TIMER, pwm_val);
-            pwmSet(MOTOR_C_TIMER, 0.f);
-            break;
-
-        case PHASE_100:
-            resetLines(0, 0xff, 0xff);
-            pwmSet(MOTOR_C_TIMER, pwm_val);
-            pwmSet(MOTOR_B_TIMER, 0.f);
-            break;
-
-        case PHASE_101:
-            resetLines(0xff, 0xff, 0);
-            pwmSet(MOTOR_A_TIMER, pwm_val);
-            pwmSet(MOTOR_B_TIMER, 0.f);
-            break;
-
-        case PHASE_110:
-            resetLines(0xff, 0, 0xff);
-            pwmSet(MOTOR_C_TIMER, pwm_val);
-            pwmSet(MOTOR_A_TIMER, 0.f);
-            break;
-        }
-}
-
-
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "inc/hw_memmap.h"
+#include "driverlib/timer.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+
+#include "motorLib.h"
+
+
+void resetLines(uint8_t val_a, uint8_t val_b, uint8_t val_c)
+{
+    GPIOPinWrite(EGH456_RESET_A, val_a);
+    GPIOPinWrite(EGH456_RESET_B, val_b);
+    GPIOPinWrite(EGH456_RESET_C, val_c);
+}
+
+#ifdef MOTOR_PWM_MODULE
+void motorPwmInit(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_PWM0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOG);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOK);
+
+    GPIOPinConfigure(GPIO_PF2_M0PWM2);
+    GPIOPinConfigure(GPIO_PG0_M0PWM4);
+    GPIOPinConfigure(GPIO_PK4_M0PWM6);
+    GPIOPinTypePWM(GPIO_PORTF_BASE, GPIO_PIN_2);
+    GPIOPinTypePWM(GPIO_PORTG_BASE, GPIO_PIN_0);
+    GPIOPinTypePWM(GPIO_PORTK_BASE, GPIO_PIN_4);
+
+    // Up/down counting centres each pulse on the top of the count. Compare
+    // values and output enables only change when driveMotor() asks for a sync
+    // update
+    PWMClockSet(PWM0_BASE, MOTOR_PWM_CLOCK);
+    PWMGenConfigure(PWM0_BASE, PWM_GEN_1, PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_SYNC);
+    PWMGenConfigure(PWM0_BASE, PWM_GEN_2, PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_SYNC);
+    PWMGenConfigure(PWM0_BASE, PWM_GEN_3, PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_SYNC);
+    PWMGenPeriodSet(PWM0_BASE, PWM_GEN_1, MOTOR_PWM_PERIOD);
+    PWMGenPeriodSet(PWM0_BASE, PWM_GEN_2, MOTOR_PWM_PERIOD);
+    PWMGenPeriodSet(PWM0_BASE, PWM_GEN_3, MOTOR_PWM_PERIOD);
+
+    // No dead band: the gate driver takes one PWM input and a reset line per
+    // half bridge and times its own switching, so the generator dead band would
+    // only shorten every high pulse
+
+    PWMOutputUpdateMode(PWM0_BASE, MOTOR_PWM_OUT_BITS, PWM_OUTPUT_MODE_SYNC_GLOBAL);
+    PWMOutputState(PWM0_BASE, MOTOR_PWM_OUT_BITS, false);
+    PWMGenEnable(PWM0_BASE, PWM_GEN_1);
+    PWMGenEnable(PWM0_BASE, PWM_GEN_2);
+    PWMGenEnable(PWM0_BASE, PWM_GEN_3);
+
+    // Restart every generator together, so the ADC sample clock on generator 0
+    // keeps landing on the top of the motor count
+    PWMSyncTimeBase(PWM0_BASE, PWM_GEN_0_BIT | MOTOR_PWM_GEN_BITS);
+}
+
+void pwmSet(uint32_t pwm_base, uint32_t pwm_out, int32_t pwm_val)
+{
+    // A zero width pulse isn't possible, so an idle phase has its output turned off
+    if (pwm_val > 0) {
+        PWMPulseWidthSet(pwm_base, pwm_out, pwm_val);
+        PWMOutputState(pwm_base, 1 << (pwm_out & 0x7), true);
+    } else {
+        PWMOutputState(pwm_base, 1 << (pwm_out & 0x7), false);
+    }
+}
+#else
+void pwmSet(uint32_t timer_base, uint32_t timer, int32_t pwm_val)
+{
+//    uint32_t pwm_val = 999 * pwm_percent / 100;
+    TimerMatchSet(timer_base, timer, pwm_val);
+}
+#endif
+
+
+void driveMotor(uint8_t phase, int32_t pwm_val)
+{
+    switch(phase)
+        {
+
+        case PHASE_001:
+            resetLines(0xff, 0, 0xff);
+            pwmSet(MOTOR_A_TIMER, pwm_val);
+            pwmSet(MOTOR_C_TIMER, 0.f);
+            break;
+
+        case PHASE_010:
+            resetLines(0xff, 0xff, 0);
+            pwmSet(MOTOR_B_TIMER, pwm_val);
+            pwmSet(MOTOR_A_TIMER, 0.f);
+            break;
+
+        case PHASE_011:
+            resetLines(0, 0xff, 0xff);
+            pwmSet(MOTOR_B_TIMER, pwm_val);
+            pwmSet(MOTOR_C_TIMER, 0.f);
+            break;
+
+        case PHASE_100:
+            resetLines(0, 0xff, 0xff);
+            pwmSet(MOTOR_C_TIMER, pwm_val);
+            pwmSet(MOTOR_B_TIMER, 0.f);
+            break;
+
+        case PHASE_101:
+            resetLines(0xff, 0xff, 0);
+            pwmSet(MOTOR_A_TIMER, pwm_val);
+            pwmSet(MOTOR_B_TIMER, 0.f);
+            break;
+
+        case PHASE_110:
+            resetLines(0xff, 0, 0xff);
+            pwmSet(MOTOR_C_TIMER, pwm_val);
+            pwmSet(MOTOR_A_TIMER, 0.f);
+            break;
+        }
+
+#ifdef MOTOR_PWM_MODULE
+    // Both phases change at the same counter zero
+    PWMSyncUpdate(PWM0_BASE, MOTOR_PWM_GEN_BITS);
+#endif
+}
+
+void driveMotorPhases(int32_t pwm_a, int32_t pwm_b, int32_t pwm_c)
+{
+    resetLines(0xff, 0xff, 0xff);
+    pwmSet(MOTOR_A_TIMER, pwm_a);
+    pwmSet(MOTOR_B_TIMER, pwm_b);
+    pwmSet(MOTOR_C_TIMER, pwm_c);
+
+#ifdef MOTOR_PWM_MODULE
+    PWMSyncUpdate(PWM0_BASE, MOTOR_PWM_GEN_BITS);
+#endif
+}
+
+
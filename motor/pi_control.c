@@ -0,0 +1,118 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "pi_control.h"
+
+/*
+ * Function Prototypes
+ */
+void PIControllerInit(PIController *pi, int32_t kp, int32_t ki, int32_t out_min, int32_t out_max);
+void PIControllerSetGains(PIController *pi, int32_t kp, int32_t ki);
+void PIControllerSetLimits(PIController *pi, int32_t out_min, int32_t out_max, int32_t integrator_limit, int32_t max_step);
+void PIControllerSetBackCalculation(PIController *pi, int32_t kb);
+void PIControllerHoldIntegrator(PIController *pi, bool hold);
+void PIControllerReset(PIController *pi, int32_t output);
+int32_t PIControllerUpdate(PIController *pi, int32_t error);
+static int32_t Saturate(int64_t value, int32_t low, int32_t high);
+
+/*
+ * Sets up a PI controller with the given gains and output range. The integrator
+ * is clamped to the output range, there is no rate limit and the whole of any
+ * saturation is fed back into the integrator until changed.
+ */
+void PIControllerInit(PIController *pi, int32_t kp, int32_t ki, int32_t out_min, int32_t out_max) {
+    pi->kp = kp;
+    pi->ki = ki;
+    pi->kb = PI_ONE;
+    pi->out_min = out_min;
+    pi->out_max = out_max;
+    pi->integrator_limit = (out_max > -out_min) ? out_max : -out_min;
+    pi->max_step = INT32_MAX;
+    pi->hold = false;
+    PIControllerReset(pi, 0);
+}
+
+void PIControllerSetGains(PIController *pi, int32_t kp, int32_t ki) {
+    pi->kp = kp;
+    pi->ki = ki;
+}
+
+void PIControllerSetLimits(PIController *pi, int32_t out_min, int32_t out_max, int32_t integrator_limit, int32_t max_step) {
+    pi->out_min = out_min;
+    pi->out_max = out_max;
+    pi->integrator_limit = integrator_limit;
+    pi->max_step = max_step;
+}
+
+void PIControllerSetBackCalculation(PIController *pi, int32_t kb) {
+    pi->kb = kb;
+}
+
+/*
+ * Stops the integrator taking in the error, or any back-calculation, until
+ * released. The proportional term and the limits carry on as normal.
+ */
+void PIControllerHoldIntegrator(PIController *pi, bool hold) {
+    pi->hold = hold;
+}
+
+/*
+ * Restarts the controller so its next output continues smoothly from the given value.
+ */
+void PIControllerReset(PIController *pi, int32_t output) {
+    pi->output = Saturate(output, pi->out_min, pi->out_max);
+    pi->integrator = Saturate(pi->output, -pi->integrator_limit, pi->integrator_limit);
+}
+
+/*
+ * Runs one controller update for the given error and returns the new output.
+ *
+ * Whatever the output range and rate limit remove from the unlimited output is
+ * fed back into the integrator (scaled by kb), so the integrator stops winding
+ * up as soon as the output saturates in either direction.
+ */
+int32_t PIControllerUpdate(PIController *pi, int32_t error) {
+    int32_t proportional, unlimited, output, step_low, step_high;
+    int64_t scaled, feedback, remainder;
+
+    proportional = Saturate((int64_t)pi->kp * error, -PI_ONE * 64, PI_ONE * 64);
+    if (!pi->hold) {
+        pi->integrator = Saturate((int64_t)pi->integrator + (int64_t)pi->ki * error,
+                                  -pi->integrator_limit, pi->integrator_limit);
+    }
+    unlimited = Saturate((int64_t)proportional + pi->integrator, INT32_MIN, INT32_MAX);
+
+    step_low = Saturate((int64_t)pi->output - pi->max_step, INT32_MIN, INT32_MAX);
+    step_high = Saturate((int64_t)pi->output + pi->max_step, INT32_MIN, INT32_MAX);
+    output = Saturate(unlimited, pi->out_min, pi->out_max);
+    output = Saturate(output, step_low, step_high);
+
+    if (output != unlimited && !pi->hold) {
+        // rounded rather than floored, which would bias the integrator down
+        // by half an LSB on every limited update. Ties go to even, a fractional
+        // kb such as 0.5 hits them on every other update and rounding them all
+        // up would bias the integrator the other way.
+        scaled = (int64_t)pi->kb * ((int64_t)output - unlimited);
+        feedback = scaled >> PI_Q;
+        remainder = scaled - (feedback << PI_Q);
+        if (remainder > (1 << (PI_Q - 1)) || (remainder == (1 << (PI_Q - 1)) && (feedback & 1))) {
+            feedback++;
+        }
+        pi->integrator = Saturate((int64_t)pi->integrator + feedback, -pi->integrator_limit, pi->integrator_limit);
+    }
+
+    pi->output = output;
+    return output;
+}
+
+/*
+ * Clamps a 64 bit intermediate result into the given 32 bit range.
+ */
+static int32_t Saturate(int64_t value, int32_t low, int32_t high) {
+    if (value < low) {
+        return low;
+    } else if (value > high) {
+        return high;
+    }
+
+    return (int32_t)value;
+}
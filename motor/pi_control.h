@@ -0,0 +1,37 @@
+#ifndef MOTOR_PI_CONTROL_H_
+#define MOTOR_PI_CONTROL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Gains, limits and outputs are Q8.24 fixed point values, so an output of
+ * PI_ONE is 100% duty cycle. Errors are plain integers in the units of the
+ * controlled quantity (e.g. RPM).
+ */
+#define PI_Q 24
+#define PI_ONE (1 << PI_Q)
+#define PI_FROM_FLOAT(x) ((int32_t)((x) * PI_ONE))
+
+typedef struct PIController {
+    int32_t kp;               // Output per unit of error
+    int32_t ki;               // Output per unit of error per update
+    int32_t kb;               // Fraction of saturated output fed back into the integrator
+    int32_t integrator;
+    int32_t integrator_limit; // Symmetric clamp applied to the integrator
+    int32_t out_min;
+    int32_t out_max;
+    int32_t max_step;         // Largest output change allowed per update
+    int32_t output;
+    bool hold;                // Integrator left as it is while set
+} PIController;
+
+void PIControllerInit(PIController *pi, int32_t kp, int32_t ki, int32_t out_min, int32_t out_max);
+void PIControllerSetGains(PIController *pi, int32_t kp, int32_t ki);
+void PIControllerSetLimits(PIController *pi, int32_t out_min, int32_t out_max, int32_t integrator_limit, int32_t max_step);
+void PIControllerSetBackCalculation(PIController *pi, int32_t kb);
+void PIControllerHoldIntegrator(PIController *pi, bool hold);
+void PIControllerReset(PIController *pi, int32_t output);
+int32_t PIControllerUpdate(PIController *pi, int32_t error);
+
+#endif /* MOTOR_PI_CONTROL_H_ */
@@ -0,0 +1,94 @@
+#include <stdbool.h>
+#include <math.h>
+#include "ramp.h"
+
+/*
+ * Function Prototypes
+ */
+void RampInit(SpeedRamp *ramp, float max_accel, float max_decel, float max_jerk, float period);
+void RampSetLimits(SpeedRamp *ramp, float max_accel, float max_decel, float max_jerk);
+void RampSetTarget(SpeedRamp *ramp, float target);
+void RampReset(SpeedRamp *ramp, float reference);
+float RampUpdate(SpeedRamp *ramp);
+bool RampIsSettled(const SpeedRamp *ramp);
+
+/*
+ * Sets up a ramp that is sitting still at 0 with the given limits, to be
+ * updated every period seconds.
+ */
+void RampInit(SpeedRamp *ramp, float max_accel, float max_decel, float max_jerk, float period) {
+    ramp->period = period;
+    RampSetLimits(ramp, max_accel, max_decel, max_jerk);
+    RampReset(ramp, 0);
+}
+
+void RampSetLimits(SpeedRamp *ramp, float max_accel, float max_decel, float max_jerk) {
+    ramp->max_accel = max_accel;
+    ramp->max_decel = max_decel;
+    ramp->max_jerk = max_jerk;
+}
+
+/*
+ * Changes the speed the ramp is heading towards. The reference keeps moving
+ * smoothly from wherever it currently is.
+ */
+void RampSetTarget(SpeedRamp *ramp, float target) {
+    ramp->target = target;
+}
+
+/*
+ * Jumps the reference straight to the given speed and holds it there.
+ */
+void RampReset(SpeedRamp *ramp, float reference) {
+    ramp->reference = reference;
+    ramp->target = reference;
+    ramp->acceleration = 0;
+}
+
+/*
+ * Advances the reference by one period and returns it.
+ *
+ * Acceleration only ever changes by max_jerk per second. Each update checks how
+ * much speed would still be gained if the acceleration were wound back to zero
+ * from now on, and starts winding it back once that would reach the target, so
+ * the reference arrives with zero acceleration instead of overshooting.
+ */
+float RampUpdate(SpeedRamp *ramp) {
+    float remaining, stopping, desired, step;
+
+    remaining = ramp->target - ramp->reference;
+    stopping = ramp->acceleration * fabsf(ramp->acceleration) / (2 * ramp->max_jerk);
+    step = ramp->max_jerk * ramp->period;
+
+    // Close enough that the remaining jerk step would carry it past the target
+    if (fabsf(remaining) <= fabsf(ramp->acceleration) * ramp->period + step * ramp->period
+            && fabsf(ramp->acceleration) <= step) {
+        ramp->reference = ramp->target;
+        ramp->acceleration = 0;
+        return ramp->reference;
+    }
+
+    if (remaining - stopping > 0) {
+        desired = ramp->max_accel;
+    } else if (remaining - stopping < 0) {
+        desired = -ramp->max_decel;
+    } else {
+        desired = 0;
+    }
+
+    if (ramp->acceleration < desired) {
+        ramp->acceleration = fminf(ramp->acceleration + step, desired);
+    } else {
+        ramp->acceleration = fmaxf(ramp->acceleration - step, desired);
+    }
+
+    ramp->reference += ramp->acceleration * ramp->period;
+    return ramp->reference;
+}
+
+/*
+ * Returns whether the reference has reached its target and stopped changing.
+ */
+bool RampIsSettled(const SpeedRamp *ramp) {
+    return ramp->reference == ramp->target && ramp->acceleration == 0;
+}
@@ -0,0 +1,27 @@
+#ifndef MOTOR_RAMP_H_
+#define MOTOR_RAMP_H_
+
+#include <stdbool.h>
+
+/*
+ * Jerk limited (S-curve) reference generator. Speeds are in RPM, acceleration
+ * limits in RPM/s and the jerk limit in RPM/s^2.
+ */
+typedef struct SpeedRamp {
+    float reference;
+    float acceleration;
+    float target;
+    float max_accel;
+    float max_decel;
+    float max_jerk;
+    float period; // Seconds between calls to RampUpdate()
+} SpeedRamp;
+
+void RampInit(SpeedRamp *ramp, float max_accel, float max_decel, float max_jerk, float period);
+void RampSetLimits(SpeedRamp *ramp, float max_accel, float max_decel, float max_jerk);
+void RampSetTarget(SpeedRamp *ramp, float target);
+void RampReset(SpeedRamp *ramp, float reference);
+float RampUpdate(SpeedRamp *ramp);
+bool RampIsSettled(const SpeedRamp *ramp);
+
+#endif /* MOTOR_RAMP_H_ */
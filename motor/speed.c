@@ -1,434 +1,989 @@
-#include <stdint.h>
-#include <stdbool.h>
-#include <driverlib/sysctl.h>
-#include <driverlib/pin_map.h>
-#include <driverlib/gpio.h>
-#include <driverlib/timer.h>
-#include <driverlib/pwm.h>
-#include <inc/hw_memmap.h>
-#include <xdc/runtime/System.h>
-#include "motor/measurement.h"
-#include "motorLib.h"
-
-/*
- * Module constants.
- */
-#define NUM_STATES 6
-#define MILLISECONDS_IN_MINUTE 6000
-#define MAX_SPEED 1000 // Max speed at which present motor can spin in revolutions per minute (RPM), determined through trial and error
-#define T_CPU_CLOCK_SPEED 120000000
-#define SAMPLING_FREQUENCY 500000 // Fixed PWM frequency at which motor performs best (Time Period = 2us at 500000 value)
-#define MAX_DUTY 0.95 // Ensure there is enough room for a 100ns low PWM pulse as specified in page 14 of motor datasheet
-#define MAX_INCREMENT 0.00001
-#define MIN_INCREMENT -1*MAX_INCREMENT
-#define CHECK_INTERVAL 250
-#define MAX_ERROR_SUM 10
-#define STARTING_DUTY 0.05
-#define PI_INTERVAL 50
-#define KP MAX_INCREMENT/100
-#define KI KP/100
-
-static const uint8_t HALL_SENSOR_STATES[NUM_STATES] = {100, 101, 1, 11, 10, 110};
-//static const uint16_t TIMER_CYCLES = T_CPU_CLOCK_SPEED / SAMPLING_FREQUENCY;
-static const int32_t TIMER_CYCLES = T_CPU_CLOCK_SPEED / SAMPLING_FREQUENCY;
-
-/*
- * Module variables.
- */
-static uint8_t current_state, checkpoint_state, current_sequence;
-//static uint16_t match_point;
-static int32_t match_point;
-static int milliseconds = 0;
-static double current_speed = 0, desired_speed = 0, duty_cycle = STARTING_DUTY, error_sum = 0, revolutions = 0;
-static bool run_motor = false, faulty_motor = false, state_changed = false;
-/*
- * Function Prototypes.
- */
-int ConnectWithHallSensors();
-void ConnectWithMotor();
-void StartMotor();
-bool IsMotorFaulty();
-void RotateMotor();
-double GetMotorSpeed();
-void SetMotorSpeed(int speed);
-void StopMotor();
-static void CheckForFaultSignal();
-static uint8_t GetCurrentHallState();
-static void AddToCurrentRevolutions();
-static void PIControl();
-static void FeedbackControl();
-
-void PortCIntHandler () {
-    GPIOIntClear(GPIO_PORTC_BASE, GPIO_INT_PIN_6);
-    //CheckForFaultSignal();
-    revolutions += 0.16666;
-    state_changed = true;
-}
-
-void PortLIntHandler () {
-    GPIOIntClear(GPIO_PORTL_BASE, GPIO_INT_PIN_2 | GPIO_INT_PIN_3);
-    //CheckForFaultSignal();
-    revolutions += 0.16666;
-    state_changed = true;
-}
-
-void PortPIntHandler () {
-    GPIOIntClear(GPIO_PORTP_BASE, GPIO_INT_PIN_4 | GPIO_INT_PIN_5);
-    revolutions += 0.16666;
-    state_changed = true;
-}
-
-/*
- * Initializes connection to read from all three hall sensors and fault lines.
- *
- * Output: Hall sensor readings that the calling function can check for any
- * faults (represented by -1).
- */
-int ConnectWithHallSensors() {
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOL);
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOP);
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
-    GPIOPinTypeGPIOInput(GPIO_PORTC_BASE, GPIO_PIN_6);
-    GPIOPinTypeGPIOInput(GPIO_PORTL_BASE, GPIO_PIN_2 | GPIO_PIN_3);
-    GPIOPinTypeGPIOInput(GPIO_PORTP_BASE, GPIO_PIN_4 | GPIO_PIN_5);
-    GPIOIntRegister(GPIO_PORTC_BASE, PortCIntHandler);
-    GPIOIntRegister(GPIO_PORTL_BASE, PortLIntHandler);
-    GPIOIntRegister(GPIO_PORTP_BASE, PortPIntHandler);
-    GPIOIntTypeSet(GPIO_PORTC_BASE, GPIO_INT_PIN_6, GPIO_BOTH_EDGES);
-    GPIOIntTypeSet(GPIO_PORTL_BASE, GPIO_INT_PIN_2 | GPIO_INT_PIN_3, GPIO_BOTH_EDGES);
-    GPIOIntTypeSet(GPIO_PORTP_BASE, GPIO_INT_PIN_4 | GPIO_INT_PIN_5, GPIO_BOTH_EDGES);
-    current_state = GetCurrentHallState();
-    checkpoint_state = current_state;
-
-    if (checkpoint_state >= 0 && checkpoint_state <= 5) {
-        return ((int)checkpoint_state);
-    } else {
-        return -1;
-    }
-}
-
-/*
- * Initializes all the connections needed to send a PWM wave through to the
- * motor's half wave bridges.
- */
-void ConnectWithMotor() {
-    // Initiate connection with motor's half bridges and fault sensor
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOM);
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOL);
-    //SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
-
-    // Initialize timer hardware for PWM wave
-    //SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER2);
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER3);
-
-    // Configure PWM pins
-    GPIOPinConfigure(GPIO_PM0_T2CCP0);
-    GPIOPinConfigure(GPIO_PM1_T2CCP1);
-    GPIOPinConfigure(GPIO_PM2_T3CCP0);
-    //GPIOPinConfigure(GPIO_PA7_T3CCP1);
-    //GPIOPinConfigure(GPIO_PL4_T0CCP0);
-    //GPIOPinConfigure(GPIO_PL5_T0CCP1);
-    GPIOPinTypeTimer(GPIO_PORTM_BASE, GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2);
-    //GPIOPinTypeTimer(GPIO_PORTL_BASE, GPIO_PIN_4 | GPIO_PIN_5);
-    //GPIOPinTypeTimer(GPIO_PORTA_BASE, GPIO_PIN_7);
-    GPIOPinTypeGPIOOutput(GPIO_PORTL_BASE, GPIO_PIN_4 | GPIO_PIN_5);
-    GPIOPinTypeGPIOOutput(GPIO_PORTA_BASE, GPIO_PIN_7);
-
-    // Configure timers to send PWM wave later on
-    //TimerDisable(TIMER0_BASE, TIMER_BOTH);
-    TimerDisable(TIMER2_BASE, TIMER_BOTH);
-    //TimerDisable(TIMER3_BASE, TIMER_BOTH);
-    TimerDisable(TIMER3_BASE, TIMER_A);
-    //TimerConfigure(TIMER0_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PWM | TIMER_CFG_B_PWM);
-    TimerConfigure(TIMER2_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PWM | TIMER_CFG_B_PWM);
-    //TimerConfigure(TIMER3_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PWM | TIMER_CFG_B_PWM);
-    TimerConfigure(TIMER3_BASE, TIMER_CFG_A_PWM);
-    //TimerLoadSet(TIMER0_BASE, TIMER_BOTH, TIMER_CYCLES);
-    TimerLoadSet(TIMER2_BASE, TIMER_BOTH, TIMER_CYCLES);
-    //TimerLoadSet(TIMER3_BASE, TIMER_BOTH, TIMER_CYCLES);
-    TimerLoadSet(TIMER3_BASE, TIMER_A, TIMER_CYCLES);
-    //TimerMatchSet(TIMER0_BASE, TIMER_BOTH, TIMER_CYCLES);
-    TimerMatchSet(TIMER2_BASE, TIMER_BOTH, TIMER_CYCLES);
-    //TimerMatchSet(TIMER3_BASE, TIMER_BOTH, TIMER_CYCLES);
-    TimerMatchSet(TIMER3_BASE, TIMER_A, TIMER_CYCLES);
-}
-
-/*
- * Initialises and enables all the connections needed to start the motor.
- */
-void StartMotor() {
-    //TimerEnable(TIMER0_BASE, TIMER_BOTH);
-    //TimerControlLevel(TIMER0_BASE, TIMER_BOTH, true);
-    TimerEnable(TIMER2_BASE, TIMER_BOTH);
-    TimerControlLevel(TIMER2_BASE, TIMER_BOTH, true);
-    //TimerEnable(TIMER3_BASE, TIMER_BOTH);
-    //TimerControlLevel(TIMER3_BASE, TIMER_BOTH, true);
-    TimerEnable(TIMER3_BASE, TIMER_A);
-    TimerControlLevel(TIMER3_BASE, TIMER_A, true);
-    GPIOIntEnable(GPIO_PORTC_BASE, GPIO_INT_PIN_6);
-    GPIOIntEnable(GPIO_PORTL_BASE, GPIO_INT_PIN_2 | GPIO_INT_PIN_3);
-    GPIOIntEnable(GPIO_PORTP_BASE, GPIO_INT_PIN_4 | GPIO_INT_PIN_5);
-    match_point = TIMER_CYCLES-1;
-    current_speed = 0;
-    duty_cycle = STARTING_DUTY;
-    error_sum = 0;
-    revolutions = 0;
-    milliseconds = 0;
-    state_changed = false;
-    run_motor = true;
-}
-
-/*
- * Returns whether the motor is in a faulty state or not.
- */
-bool IsMotorFaulty() {
-    return faulty_motor;
-}
-
-/*
- * Changes PWM cycle sent to motor depending upon current hall sensor reading of motor.
- *
- * Assumption: StartMotor() has been called before this function.
- */
-void RotateMotor() {
-    if (!run_motor) {
-        return;
-    }
-
-    //TimerSynchronize(TIMER0_BASE, (TIMER_0A_SYNC | TIMER_0B_SYNC | TIMER_2A_SYNC | TIMER_2B_SYNC | TIMER_3A_SYNC | TIMER_3B_SYNC));
-    TimerSynchronize(TIMER0_BASE, (TIMER_2A_SYNC | TIMER_2B_SYNC | TIMER_3A_SYNC));
-    //match_point = ((uint16_t)(TIMER_CYCLES - (duty_cycle * TIMER_CYCLES)));
-    match_point = ((int32_t)(duty_cycle * TIMER_CYCLES));//((int32_t)(TIMER_CYCLES - (duty_cycle * TIMER_CYCLES)));
-    current_state = GetCurrentHallState();
-    CheckForFaultSignal();
-
-    // Motor cannot have interrupts if it is not moving
-    //FeedbackControl();
-    driveMotor(current_sequence, match_point);
-    PIControl();
-    if (state_changed) {//(GetFilteredSpeed() == 0 || current_state != checkpoint_state) {
-        state_changed = false;
-    }
-
-    ++milliseconds;
-    if (milliseconds >= CHECK_INTERVAL) {
-        current_speed = (MILLISECONDS_IN_MINUTE / milliseconds) * revolutions;
-        revolutions = 0;
-        milliseconds = 0;
-    }
-}
-
-/*
- * Returns the currently recorded speed for the motor.
- */
-double GetMotorSpeed() {
-    return current_speed;
-}
-
-/*
- * Brings the motor speed up or down to the desired speed by using a
- * safe acceleration or deceleration margin until it has reached
- * desired speed.
- */
-void SetMotorSpeed(int speed) {
-    // User input error handling for unsupported speed demands
-    if (speed <= 0) {
-        desired_speed = 0; // This is because the UI doesn't let me select speeds other than 0, WILL CHANGE IT TO duty_cycle = 0
-    } else if(speed >= MAX_SPEED) {
-        desired_speed = MAX_SPEED;
-    } else {
-        desired_speed = speed;
-    }
-}
-
-/*
- * Brings the motor to a stopping state and when the speed is low enough, stops the motor itself.
- */
-void StopMotor() {
-    run_motor = false;
-    duty_cycle = STARTING_DUTY;
-    current_speed = 0;
-    error_sum = 0;
-    revolutions = 0;
-    milliseconds = 0;
-    state_changed = false;
-    GPIOIntDisable(GPIO_PORTC_BASE, GPIO_INT_PIN_6);
-    GPIOIntDisable(GPIO_PORTL_BASE, GPIO_INT_PIN_2 | GPIO_INT_PIN_3);
-    GPIOIntDisable(GPIO_PORTP_BASE, GPIO_INT_PIN_4 | GPIO_INT_PIN_5);
-    //TimerDisable(TIMER0_BASE, TIMER_BOTH);
-    TimerDisable(TIMER2_BASE, TIMER_BOTH);
-    //TimerDisable(TIMER3_BASE, TIMER_BOTH);
-    TimerDisable(TIMER3_BASE, TIMER_A);
-}
-
-/*
- * Keeps checking whether the motor has sent a overheating or excess current fault reading.
- */
-static void CheckForFaultSignal() {
-    uint8_t f1, f2, sum;
-    f1 = (GPIOPinRead(GPIO_PORTC_BASE, GPIO_PIN_6) >> 6) & 1;
-    f2 = (GPIOPinRead(GPIO_PORTL_BASE, GPIO_PIN_2) >> 2) & 1;
-    sum = f1 + f2;
-
-    if (sum == 0) {
-        faulty_motor = true;
-    }
-}
-
-/*
- * Gets the current hall state sensors' reading.
- */
-static uint8_t GetCurrentHallState() {
-    uint8_t i, h1, h2, h3, checkpoint;
-    h1 = (GPIOPinRead(GPIO_PORTL_BASE, GPIO_PIN_3) >> 3) & 1;
-    h2 = (GPIOPinRead(GPIO_PORTP_BASE, GPIO_PIN_4) >> 4) & 1;
-    h3 = (GPIOPinRead(GPIO_PORTP_BASE, GPIO_PIN_5) >> 5) & 1;
-    current_sequence = (h3 << 2) | (h2 << 1) | h1;
-    checkpoint = h3*100 + h2*10 + h1;
-
-    for (i = 0; i < 6; i++) {
-        if (checkpoint == HALL_SENSOR_STATES[i]) {
-            return i;
-        }
-    }
-
-    faulty_motor = true;
-    return 100; // reading to indicate hardware fault
-}
-
-/*
- * Measures distance traveled from previous reference point to help calculate motor
- * speed in revolutions per minute (RPM).
- *
- * Assumption: At most one rotation could have happened since this function was
- * last called.
- */
-static void AddToCurrentRevolutions() {
-    int difference = checkpoint_state - current_state;
-    if (difference < 0) { // measurable change in states can only be from 0 to 5
-        difference += NUM_STATES;
-    }
-
-    revolutions += (difference / ((double)NUM_STATES));
-    checkpoint_state = current_state;
-}
-
-/*
- * Accelerates or decelerates the motor by a safe margin (using a PI controller as suggested in
- * week 7 lecture) to get it to go to a desirable speed.
- */
-static void PIControl() {
-    double error = 0, duty_inc = 0;
-    error = desired_speed - GetFilteredSpeed();
-    error_sum += error;
-    duty_inc = (KP*error + KI*error_sum);
-
-    // Ensure error sum is a reasonable value
-    if (error_sum >= MAX_ERROR_SUM) {
-        error_sum = MAX_ERROR_SUM;
-    }
-
-    // Ensure acceleration or deceleration doesn't get out of hand
-    if (duty_inc >= MAX_INCREMENT) {
-        duty_inc = MAX_INCREMENT;
-    } else if (duty_inc <= MIN_INCREMENT) {
-        duty_inc = MIN_INCREMENT;
-    }
-
-    duty_cycle += duty_inc;
-    // Ensure max speed doesn't get out of control
-    if (duty_cycle >= MAX_DUTY) {
-        duty_cycle = MAX_DUTY;
-    }
-}
-
-/*
- * Helper function to change the PWM waves sent to motor depending upon current
- * hall sensor position of motor.
- */
-static void FeedbackControl() {
-    switch (current_state) {
-        case 0: // H1, H2, H3 = 0, 0, 1
-            // PWM + RESET A
-            TimerMatchSet(TIMER3_BASE, TIMER_A, match_point);
-            TimerMatchSet(TIMER3_BASE, TIMER_B, 0);
-
-            // PWM + RESET B
-            TimerMatchSet(TIMER2_BASE, TIMER_B, TIMER_CYCLES);
-            TimerMatchSet(TIMER0_BASE, TIMER_B, TIMER_CYCLES);
-
-            // PWM + RESET C
-            TimerMatchSet(TIMER2_BASE, TIMER_A, match_point);
-            TimerMatchSet(TIMER0_BASE, TIMER_A, TIMER_CYCLES);
-            break;
-        case 1: // H1, H2, H3 = 1, 0, 1
-            // PWM + RESET A
-            TimerMatchSet(TIMER3_BASE, TIMER_A, match_point);
-            TimerMatchSet(TIMER3_BASE, TIMER_B, TIMER_CYCLES);
-
-            // PWM + RESET B
-            TimerMatchSet(TIMER2_BASE, TIMER_B, TIMER_CYCLES);
-            TimerMatchSet(TIMER0_BASE, TIMER_B, TIMER_CYCLES);
-
-            // PWM + RESET C
-            TimerMatchSet(TIMER2_BASE, TIMER_A, TIMER_CYCLES);
-            TimerMatchSet(TIMER0_BASE, TIMER_A, 0);
-            break;
-        case 2: // H1, H2, H3 = 1, 0, 0
-            // PWM + RESET A
-            TimerMatchSet(TIMER3_BASE, TIMER_A, match_point);
-            TimerMatchSet(TIMER3_BASE, TIMER_B, TIMER_CYCLES);
-
-            // PWM + RESET B
-            TimerMatchSet(TIMER2_BASE, TIMER_B, match_point);
-            TimerMatchSet(TIMER0_BASE, TIMER_B, 0);
-
-            // PWM + RESET C
-            TimerMatchSet(TIMER2_BASE, TIMER_A, TIMER_CYCLES);
-            TimerMatchSet(TIMER0_BASE, TIMER_A, TIMER_CYCLES);
-            break;
-        case 3: // H1, H2, H3 = 1, 1, 0
-            // PWM + RESET A
-            TimerMatchSet(TIMER3_BASE, TIMER_A, TIMER_CYCLES);
-            TimerMatchSet(TIMER3_BASE, TIMER_B, 0);
-
-            // PWM + RESET B
-            TimerMatchSet(TIMER2_BASE, TIMER_B, match_point);
-            TimerMatchSet(TIMER0_BASE, TIMER_B, TIMER_CYCLES);
-
-            // PWM + RESET C
-            TimerMatchSet(TIMER2_BASE, TIMER_A, TIMER_CYCLES);
-            TimerMatchSet(TIMER0_BASE, TIMER_A, TIMER_CYCLES);
-            break;
-        case 4: // H1, H2, H3 = 0, 1, 0
-            // PWM + RESET A
-            TimerMatchSet(TIMER3_BASE, TIMER_A, TIMER_CYCLES);
-            TimerMatchSet(TIMER3_BASE, TIMER_B, TIMER_CYCLES);
-
-            // PWM + RESET B
-            TimerMatchSet(TIMER2_BASE, TIMER_B, match_point);
-            TimerMatchSet(TIMER0_BASE, TIMER_B, TIMER_CYCLES);
-
-            // PWM + RESET C
-            TimerMatchSet(TIMER2_BASE, TIMER_A, match_point);
-            TimerMatchSet(TIMER0_BASE, TIMER_A, 0);
-            break;
-        case 5: // H1, H2, H3 = 0, 1, 1
-            // PWM + RESET A
-            TimerMatchSet(TIMER3_BASE, TIMER_A, TIMER_CYCLES);
-            TimerMatchSet(TIMER3_BASE, TIMER_B, TIMER_CYCLES);
-
-            // PWM + RESET B
-            TimerMatchSet(TIMER2_BASE, TIMER_B, TIMER_CYCLES);
-            TimerMatchSet(TIMER0_BASE, TIMER_B, 0);
-
-            // PWM + RESET C
-            TimerMatchSet(TIMER2_BASE, TIMER_A, match_point);
-            TimerMatchSet(TIMER0_BASE, TIMER_A, TIMER_CYCLES);
-            break;
-        default: // Motor shouldn't reach here in non-faulty state
-            faulty_motor = true;
-            break;
-    }
-}
+#include <stdint.h>
+#include <stdbool.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/pin_map.h>
+#include <driverlib/gpio.h>
+#include <driverlib/timer.h>
+#include <driverlib/pwm.h>
+#include <inc/hw_memmap.h>
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include "motor/measurement.h"
+#include "acquisition.h"
+#include "motorLib.h"
+#include "autotune.h"
+#include "benchmark.h"
+#include "pi_control.h"
+#include "ramp.h"
+#include "timing.h"
+#include "utils/sine.h"
+
+/*
+ * Module constants.
+ */
+#define NUM_STATES 6
+#define SECONDS_IN_MINUTE 60
+#define MAX_SPEED 1000 // Max speed at which present motor can spin in revolutions per minute (RPM), determined through trial and error
+#define T_CPU_CLOCK_SPEED 120000000
+#define SAMPLING_FREQUENCY 500000 // Fixed PWM frequency at which motor performs best (Time Period = 2us at 500000 value)
+#define MAX_DUTY PI_FROM_FLOAT(0.95) // Ensure there is enough room for a 100ns low PWM pulse as specified in page 14 of motor datasheet
+#define MAX_INCREMENT PI_FROM_FLOAT(0.0005) // Largest duty cycle change per PI update, 0 to MAX_DUTY takes about 2 seconds, 20 times what following the speed ramp needs
+#define SPEED_PERIODS NUM_STATES // Sector periods averaged per estimate, one full revolution cancels hall placement error
+#define SPEED_TIMEOUT (T_CPU_CLOCK_SPEED / 10) // Motor is considered stopped after 100 ms without a hall edge
+#define STARTING_DUTY PI_FROM_FLOAT(0.02) // Enough to break away, about 330 RPM unloaded in the simulator
+
+// The speed PI is cascaded onto an inner current loop: it produces a current
+// reference and the current PI, run on every acquisition block, sets the duty
+// cycle. Define DIRECT_DUTY_LOOP to have the speed PI set the duty cycle
+// directly instead, with the current limit enforced by folding the duty back.
+#ifndef DIRECT_DUTY_LOOP
+#define CASCADED_CURRENT_LOOP
+#endif
+
+#ifdef CASCADED_CURRENT_LOOP
+// With the current regulated the rotor is a bare inertia, and the speed
+// estimate lags by half an electrical revolution, so the speed loop has to
+// stay slow at low speed
+#define KP PI_FROM_FLOAT(0.0002) // Amps of current reference per RPM of error
+#define KI PI_FROM_FLOAT(0.0000005) // Amps per RPM of error per PI update (1 ms)
+#define STARTING_CURRENT PI_FROM_FLOAT(0.08) // Amps, about the unloaded running current, to break away without waiting on the integrator
+#define MAX_CURRENT_REFERENCE PI_FROM_FLOAT(2.0) // Amps, used while no current limit is set
+#define REFERENCE_INCREMENT PI_FROM_FLOAT(0.005) // Largest current reference change per PI update, in amps
+// The current loop crosses over at about 20 rad/s (13 mA per 0.1% duty into
+// the stalled windings): well above the speed loop, but slower than the
+// rotor, so a sudden load is held by the back EMF before the current loop
+// reacts rather than the current being held down while the rotor stalls
+#define CURRENT_KP PI_FROM_FLOAT(0.000001) // Duty cycle per mA of current error
+#define CURRENT_KI PI_FROM_FLOAT(0.0000004) // Duty cycle per mA of error per current loop update
+#define CURRENT_MAX_INCREMENT PI_FROM_FLOAT(0.002) // Largest duty cycle change per current loop update
+#else
+#define KP PI_FROM_FLOAT(0.00003) // Duty cycle per RPM of error
+#define KI PI_FROM_FLOAT(0.0000003) // Duty cycle per RPM of error per PI update (1 ms)
+#define CURRENT_SOFT_BAND 0.1f // Default foldback band as a fraction of the current limit
+#define FOLDBACK_RATE PI_FROM_FLOAT(0.002) // Duty ceiling drop per PI update at the top of the soft band
+#endif
+
+// Define to drive all three phases with sine waves instead of six-step blocks.
+// The rotor angle is interpolated between hall edges from the average sector
+// period, and the drive is refreshed on every acquisition block as well as on
+// each hall edge. The duty cycle sets the amplitude of the phase voltages.
+//#define SINUSOIDAL_DRIVE
+
+#ifdef SINUSOIDAL_DRIVE
+#define SECTOR_ANGLE 0x2AAAAAABu // 60 degrees, a full turn of sine() is 2^32
+#define PHASE_SHIFT 0x55555555u // 120 degrees between motor lines
+#define FORWARD_LEAD (-2 * SECTOR_ANGLE) // Voltage angle from hall angle, matches the six-step vector mid sector
+#define REVERSE_LEAD SECTOR_ANGLE
+#define HOLD_CYCLES (TIMING_CLOCK_SPEED / ACQUISITION_SAMPLE_RATE * ACQUISITION_BLOCK_PASSES) // Cycles the drive is held for between acquisition blocks
+#endif
+#define PI_PERIOD 0.001 // Seconds between PI updates, RotateMotor() runs every millisecond
+#define MAX_ACCELERATION 500 // RPM per second while speeding up
+#define MAX_DECELERATION 500 // RPM per second while slowing down
+#define MAX_JERK 2000 // RPM per second squared, time taken to reach full acceleration is MAX_ACCELERATION / MAX_JERK
+
+#define INVALID_HALL_STATE 100 // Sector reading to indicate hardware fault
+
+/*
+ * Hall decode tables indexed directly by the 3 bit hall code (H3 H2 H1). Each
+ * entry gives the sector the rotor is in (0 to 5 in rotation order), whether the
+ * code can occur at all, and the phase to hand to driveMotor(). Driving the
+ * complement of the hall code turns the motor the other way, so reversing is
+ * just a matter of switching tables.
+ */
+typedef struct HallEntry {
+    uint8_t sector;
+    bool valid;
+    uint8_t phase;
+} HallEntry;
+
+#define HALL_INVALID { INVALID_HALL_STATE, false, 0 }
+#define HALL_FORWARD(sector, code) { (sector), true, (code) }
+#define HALL_REVERSE(sector, code) { (sector), true, (~(code)) & 0b111 }
+
+static const HallEntry HALL_TABLE_FORWARD[8] = {
+    HALL_INVALID,
+    HALL_FORWARD(2, PHASE_001),
+    HALL_FORWARD(4, PHASE_010),
+    HALL_FORWARD(3, PHASE_011),
+    HALL_FORWARD(0, PHASE_100),
+    HALL_FORWARD(1, PHASE_101),
+    HALL_FORWARD(5, PHASE_110),
+    HALL_INVALID,
+};
+
+static const HallEntry HALL_TABLE_REVERSE[8] = {
+    HALL_INVALID,
+    HALL_REVERSE(2, PHASE_001),
+    HALL_REVERSE(4, PHASE_010),
+    HALL_REVERSE(3, PHASE_011),
+    HALL_REVERSE(0, PHASE_100),
+    HALL_REVERSE(1, PHASE_101),
+    HALL_REVERSE(5, PHASE_110),
+    HALL_INVALID,
+};
+//static const uint16_t TIMER_CYCLES = T_CPU_CLOCK_SPEED / SAMPLING_FREQUENCY;
+#ifdef MOTOR_PWM_MODULE
+static const int32_t TIMER_CYCLES = MOTOR_PWM_PERIOD;
+#else
+static const int32_t TIMER_CYCLES = T_CPU_CLOCK_SPEED / SAMPLING_FREQUENCY;
+#endif
+
+/*
+ * Module variables.
+ */
+static uint8_t current_state, checkpoint_state, current_sequence;
+//static uint16_t match_point;
+static int32_t match_point;
+static int32_t desired_speed = 0, duty_cycle = STARTING_DUTY; // duty_cycle is in PI_Q fixed point
+static uint32_t match_residue = 0; // PI_Q fraction of a timer count carried to the next match point
+static PIController speed_controller;
+#ifdef CASCADED_CURRENT_LOOP
+static PIController current_controller;
+#endif
+static volatile int32_t current_reference = 0; // speed PI output in PI_Q amps when cascaded
+static SpeedRamp speed_ramp;
+static volatile uint32_t pi_cycles = 0, max_pi_cycles = 0;
+static volatile int32_t duty_limit = MAX_DUTY, current_ceiling = MAX_DUTY;
+static volatile float current_limit = 0, soft_band = 0; // amps, 0 disables the foldback
+static uint32_t sector_periods[SPEED_PERIODS], period_sum = 0;
+static uint8_t period_index = 0, period_count = 0;
+static volatile uint32_t last_edge_time = 0;
+static volatile float current_speed = 0;
+static volatile bool edge_seen = false;
+static const HallEntry * volatile hall_table = HALL_TABLE_FORWARD;
+static volatile bool run_motor = false, faulty_motor = false, state_changed = false;
+static volatile uint32_t commutation_count = 0, last_commutation_latency = 0, max_commutation_latency = 0;
+/*
+ * Function Prototypes.
+ */
+int ConnectWithHallSensors();
+void ConnectWithMotor();
+void StartMotor();
+bool IsMotorFaulty();
+void RotateMotor();
+double GetMotorSpeed();
+void SetMotorSpeed(int speed);
+void StopMotor();
+uint32_t GetCommutationCount();
+uint32_t GetCommutationLatency();
+uint32_t GetMaxCommutationLatency();
+void ResetCommutationLatency();
+void SetSpeedControllerGains(int32_t kp, int32_t ki);
+void SetSpeedRampLimits(float max_accel, float max_decel, float max_jerk);
+bool StartSpeedAutotune();
+bool StartSpeedBenchmark();
+void SetMotorDirection(bool reverse);
+bool IsMotorReversed();
+uint32_t GetPIControlCycles();
+uint32_t GetMaxPIControlCycles();
+void SetMotorDutyLimit(float fraction);
+void SetMotorCurrentLimit(float limit, float band);
+void CurrentControl(float current);
+static int32_t SpeedOutputCeiling();
+#ifndef CASCADED_CURRENT_LOOP
+static int32_t CurrentFoldback(int32_t output);
+#endif
+static void CommutateMotor(uint32_t edge_time);
+static void RecordHallEdge(uint32_t edge_time);
+static void ResetSpeedEstimate();
+static void CheckSpeedTimeout();
+static void CheckForFaultSignal();
+static uint8_t GetCurrentHallState();
+static void PIControl();
+static void ApplyDrive();
+static int32_t DitheredMatch(int32_t duty);
+#ifdef SINUSOIDAL_DRIVE
+static uint32_t GetHallAngle();
+static int32_t PhaseValue(uint32_t angle);
+#endif
+
+/*
+ * Hall sensor and fault line interrupts. Each edge commutates the motor
+ * straight away rather than waiting for the next RotateMotor() tick, and
+ * hall edges (PL3, PP4 and PP5) are timestamped for the speed estimate.
+ * PC6 and PL2 are the fault lines, so they never count towards speed.
+ */
+void PortCIntHandler () {
+    uint32_t edge_time = TimingNow();
+    GPIOIntClear(GPIO_PORTC_BASE, GPIO_INT_PIN_6);
+    //CheckForFaultSignal();
+    state_changed = true;
+    CommutateMotor(edge_time);
+}
+
+void PortLIntHandler () {
+    uint32_t edge_time = TimingNow();
+    uint32_t status = GPIOIntStatus(GPIO_PORTL_BASE, true);
+    GPIOIntClear(GPIO_PORTL_BASE, GPIO_INT_PIN_2 | GPIO_INT_PIN_3);
+    //CheckForFaultSignal();
+    if (status & GPIO_INT_PIN_3) {
+        RecordHallEdge(edge_time);
+    }
+    state_changed = true;
+    CommutateMotor(edge_time);
+}
+
+void PortPIntHandler () {
+    uint32_t edge_time = TimingNow();
+    GPIOIntClear(GPIO_PORTP_BASE, GPIO_INT_PIN_4 | GPIO_INT_PIN_5);
+    RecordHallEdge(edge_time);
+    state_changed = true;
+    CommutateMotor(edge_time);
+}
+
+/*
+ * Initializes connection to read from all three hall sensors and fault lines.
+ *
+ * Output: Hall sensor readings that the calling function can check for any
+ * faults (represented by -1).
+ */
+int ConnectWithHallSensors() {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOL);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOP);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
+    GPIOPinTypeGPIOInput(GPIO_PORTC_BASE, GPIO_PIN_6);
+    GPIOPinTypeGPIOInput(GPIO_PORTL_BASE, GPIO_PIN_2 | GPIO_PIN_3);
+    GPIOPinTypeGPIOInput(GPIO_PORTP_BASE, GPIO_PIN_4 | GPIO_PIN_5);
+    GPIOIntRegister(GPIO_PORTC_BASE, PortCIntHandler);
+    GPIOIntRegister(GPIO_PORTL_BASE, PortLIntHandler);
+    GPIOIntRegister(GPIO_PORTP_BASE, PortPIntHandler);
+    GPIOIntTypeSet(GPIO_PORTC_BASE, GPIO_INT_PIN_6, GPIO_BOTH_EDGES);
+    GPIOIntTypeSet(GPIO_PORTL_BASE, GPIO_INT_PIN_2 | GPIO_INT_PIN_3, GPIO_BOTH_EDGES);
+    GPIOIntTypeSet(GPIO_PORTP_BASE, GPIO_INT_PIN_4 | GPIO_INT_PIN_5, GPIO_BOTH_EDGES);
+    current_state = GetCurrentHallState();
+    checkpoint_state = current_state;
+
+    if (checkpoint_state < NUM_STATES) {
+        return ((int)checkpoint_state);
+    } else {
+        return -1;
+    }
+}
+
+/*
+ * Initializes all the connections needed to send a PWM wave through to the
+ * motor's half wave bridges.
+ */
+void ConnectWithMotor() {
+    // Initiate connection with motor's half bridges and fault sensor
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOM);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOL);
+    //SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+
+    // Reset lines of the half bridges
+    GPIOPinTypeGPIOOutput(GPIO_PORTL_BASE, GPIO_PIN_4 | GPIO_PIN_5);
+    GPIOPinTypeGPIOOutput(GPIO_PORTA_BASE, GPIO_PIN_7);
+
+#ifdef MOTOR_PWM_MODULE
+    // PWM module generators, centre-aligned with the ADC sample clock
+    motorPwmInit();
+#else
+    // Initialize timer hardware for PWM wave
+    //SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER2);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER3);
+
+    // Configure PWM pins
+    GPIOPinConfigure(GPIO_PM0_T2CCP0);
+    GPIOPinConfigure(GPIO_PM1_T2CCP1);
+    GPIOPinConfigure(GPIO_PM2_T3CCP0);
+    //GPIOPinConfigure(GPIO_PA7_T3CCP1);
+    //GPIOPinConfigure(GPIO_PL4_T0CCP0);
+    //GPIOPinConfigure(GPIO_PL5_T0CCP1);
+    GPIOPinTypeTimer(GPIO_PORTM_BASE, GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2);
+    //GPIOPinTypeTimer(GPIO_PORTL_BASE, GPIO_PIN_4 | GPIO_PIN_5);
+    //GPIOPinTypeTimer(GPIO_PORTA_BASE, GPIO_PIN_7);
+
+    // Configure timers to send PWM wave later on
+    //TimerDisable(TIMER0_BASE, TIMER_BOTH);
+    TimerDisable(TIMER2_BASE, TIMER_BOTH);
+    //TimerDisable(TIMER3_BASE, TIMER_BOTH);
+    TimerDisable(TIMER3_BASE, TIMER_A);
+    //TimerConfigure(TIMER0_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PWM | TIMER_CFG_B_PWM);
+    TimerConfigure(TIMER2_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PWM | TIMER_CFG_B_PWM);
+    //TimerConfigure(TIMER3_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PWM | TIMER_CFG_B_PWM);
+    TimerConfigure(TIMER3_BASE, TIMER_CFG_A_PWM);
+    //TimerLoadSet(TIMER0_BASE, TIMER_BOTH, TIMER_CYCLES);
+    TimerLoadSet(TIMER2_BASE, TIMER_BOTH, TIMER_CYCLES);
+    //TimerLoadSet(TIMER3_BASE, TIMER_BOTH, TIMER_CYCLES);
+    TimerLoadSet(TIMER3_BASE, TIMER_A, TIMER_CYCLES);
+    //TimerMatchSet(TIMER0_BASE, TIMER_BOTH, TIMER_CYCLES);
+    TimerMatchSet(TIMER2_BASE, TIMER_BOTH, TIMER_CYCLES);
+    //TimerMatchSet(TIMER3_BASE, TIMER_BOTH, TIMER_CYCLES);
+    TimerMatchSet(TIMER3_BASE, TIMER_A, TIMER_CYCLES);
+#endif
+
+#ifdef CASCADED_CURRENT_LOOP
+    PIControllerInit(&speed_controller, KP, KI, 0, MAX_CURRENT_REFERENCE);
+    PIControllerSetLimits(&speed_controller, 0, MAX_CURRENT_REFERENCE, MAX_CURRENT_REFERENCE, REFERENCE_INCREMENT);
+    PIControllerInit(&current_controller, CURRENT_KP, CURRENT_KI, 0, MAX_DUTY);
+    PIControllerSetLimits(&current_controller, 0, MAX_DUTY, MAX_DUTY, CURRENT_MAX_INCREMENT);
+#else
+    PIControllerInit(&speed_controller, KP, KI, 0, MAX_DUTY);
+    PIControllerSetLimits(&speed_controller, 0, MAX_DUTY, MAX_DUTY, MAX_INCREMENT);
+#endif
+    RampInit(&speed_ramp, MAX_ACCELERATION, MAX_DECELERATION, MAX_JERK, PI_PERIOD);
+}
+
+/*
+ * Initialises and enables all the connections needed to start the motor.
+ */
+void StartMotor() {
+#ifndef MOTOR_PWM_MODULE
+    // the PWM module generators run from motorPwmInit(), driveMotor() turns the outputs on
+    //TimerEnable(TIMER0_BASE, TIMER_BOTH);
+    //TimerControlLevel(TIMER0_BASE, TIMER_BOTH, true);
+    TimerEnable(TIMER2_BASE, TIMER_BOTH);
+    TimerControlLevel(TIMER2_BASE, TIMER_BOTH, true);
+    //TimerEnable(TIMER3_BASE, TIMER_BOTH);
+    //TimerControlLevel(TIMER3_BASE, TIMER_BOTH, true);
+    TimerEnable(TIMER3_BASE, TIMER_A);
+    TimerControlLevel(TIMER3_BASE, TIMER_A, true);
+#endif
+    match_point = TIMER_CYCLES-1;
+    ResetSpeedEstimate();
+    current_ceiling = MAX_DUTY;
+#ifdef CASCADED_CURRENT_LOOP
+    // the current loop brings the duty cycle up to the starting current
+    duty_cycle = 0;
+    current_reference = STARTING_CURRENT;
+    PIControllerReset(&current_controller, duty_cycle);
+    PIControllerReset(&speed_controller, current_reference);
+#else
+    duty_cycle = STARTING_DUTY;
+    current_reference = 0;
+    PIControllerReset(&speed_controller, duty_cycle);
+#endif
+    RampReset(&speed_ramp, 0);
+    RampSetTarget(&speed_ramp, desired_speed);
+    state_changed = false;
+    ResetCommutationLatency();
+    run_motor = true;
+    GPIOIntEnable(GPIO_PORTC_BASE, GPIO_INT_PIN_6);
+    GPIOIntEnable(GPIO_PORTL_BASE, GPIO_INT_PIN_2 | GPIO_INT_PIN_3);
+    GPIOIntEnable(GPIO_PORTP_BASE, GPIO_INT_PIN_4 | GPIO_INT_PIN_5);
+}
+
+/*
+ * Returns whether the motor is in a faulty state or not.
+ */
+bool IsMotorFaulty() {
+    return faulty_motor;
+}
+
+/*
+ * Runs the fixed rate part of the motor control: updates the PWM duty cycle
+ * with the PI controller and refreshes the drive for the current hall state.
+ * Phase switching itself happens on each hall edge in CommutateMotor(), this
+ * only keeps the motor driven when it is stalled and no edges are arriving.
+ *
+ * Assumption: StartMotor() has been called before this function.
+ */
+void RotateMotor() {
+    UInt key;
+
+    CheckSpeedTimeout();
+    if (!run_motor) {
+        return;
+    }
+
+#ifndef MOTOR_PWM_MODULE
+    // the PWM module generators are synchronised once, in motorPwmInit(). The
+    // ADC sample clock restarts with the timers, back to back, so its trigger
+    // stays inside their on pulses
+    key = Hwi_disable();
+    //TimerSynchronize(TIMER0_BASE, (TIMER_0A_SYNC | TIMER_0B_SYNC | TIMER_2A_SYNC | TIMER_2B_SYNC | TIMER_3A_SYNC | TIMER_3B_SYNC));
+    TimerSynchronize(TIMER0_BASE, (TIMER_2A_SYNC | TIMER_2B_SYNC | TIMER_3A_SYNC));
+    SyncAcquisitionSampleClock();
+    Hwi_restore(key);
+#endif
+    // A hall edge arriving between reading the state and driving the motor
+    // would otherwise have its commutation overwritten with the stale phase,
+    // and the acquisition interrupt dithers the match point too
+    key = Hwi_disable();
+    //match_point = ((uint16_t)(TIMER_CYCLES - (duty_cycle * TIMER_CYCLES)));
+    match_point = DitheredMatch(duty_cycle);//((int32_t)(TIMER_CYCLES - (duty_cycle * TIMER_CYCLES)));
+    current_state = GetCurrentHallState();
+    ApplyDrive();
+    Hwi_restore(key);
+    CheckForFaultSignal();
+    PIControl();
+    if (state_changed) {//(GetFilteredSpeed() == 0 || current_state != checkpoint_state) {
+        state_changed = false;
+    }
+}
+
+/*
+ * Returns the most recent speed estimate for the motor in RPM. The estimate is
+ * refreshed on every hall edge, and between edges it is capped by the speed the
+ * time since the last edge allows so a slowing motor is not reported as fast.
+ * Reads as 0 once no edge has arrived within SPEED_TIMEOUT.
+ */
+double GetMotorSpeed() {
+    uint32_t elapsed;
+    float speed, ceiling;
+
+    if (!edge_seen) {
+        return 0;
+    }
+
+    speed = current_speed;
+    elapsed = TimingElapsed(last_edge_time);
+    if (elapsed > SPEED_TIMEOUT) {
+        return 0;
+    }
+
+    ceiling = ((float)T_CPU_CLOCK_SPEED * SECONDS_IN_MINUTE / NUM_STATES) / elapsed;
+    if (speed > ceiling) {
+        speed = ceiling;
+    }
+
+    return speed;
+}
+
+/*
+ * Brings the motor speed up or down to the desired speed by using a
+ * safe acceleration or deceleration margin until it has reached
+ * desired speed. The PI loop follows a jerk limited ramp towards the
+ * new speed rather than seeing it as a step.
+ */
+void SetMotorSpeed(int speed) {
+    // User input error handling for unsupported speed demands
+    if (speed <= 0) {
+        desired_speed = 0; // This is because the UI doesn't let me select speeds other than 0, WILL CHANGE IT TO duty_cycle = 0
+    } else if(speed >= MAX_SPEED) {
+        desired_speed = MAX_SPEED;
+    } else {
+        desired_speed = speed;
+    }
+
+    // An autotune run only makes sense around the set point it started with
+    AutotuneAbort();
+    RampSetTarget(&speed_ramp, desired_speed);
+}
+
+/*
+ * Changes how quickly the speed reference may move towards a new set point.
+ * Acceleration limits are in RPM/s and the jerk limit in RPM/s^2.
+ */
+void SetSpeedRampLimits(float max_accel, float max_decel, float max_jerk) {
+    RampSetLimits(&speed_ramp, max_accel, max_decel, max_jerk);
+}
+
+/*
+ * Brings the motor to a stopping state and when the speed is low enough, stops the motor itself.
+ */
+void StopMotor() {
+    run_motor = false;
+    duty_cycle = STARTING_DUTY;
+    current_reference = 0;
+#ifdef CASCADED_CURRENT_LOOP
+    PIControllerReset(&current_controller, duty_cycle);
+    PIControllerReset(&speed_controller, current_reference);
+#else
+    PIControllerReset(&speed_controller, duty_cycle);
+#endif
+    RampReset(&speed_ramp, 0);
+    AutotuneAbort();
+    BenchmarkAbort();
+    state_changed = false;
+    GPIOIntDisable(GPIO_PORTC_BASE, GPIO_INT_PIN_6);
+    GPIOIntDisable(GPIO_PORTL_BASE, GPIO_INT_PIN_2 | GPIO_INT_PIN_3);
+    GPIOIntDisable(GPIO_PORTP_BASE, GPIO_INT_PIN_4 | GPIO_INT_PIN_5);
+    ResetSpeedEstimate();
+#ifdef MOTOR_PWM_MODULE
+    PWMOutputState(PWM0_BASE, MOTOR_PWM_OUT_BITS, false);
+    PWMSyncUpdate(PWM0_BASE, MOTOR_PWM_GEN_BITS);
+#else
+    //TimerDisable(TIMER0_BASE, TIMER_BOTH);
+    TimerDisable(TIMER2_BASE, TIMER_BOTH);
+    //TimerDisable(TIMER3_BASE, TIMER_BOTH);
+    TimerDisable(TIMER3_BASE, TIMER_A);
+#endif
+}
+
+/*
+ * Limits the duty cycle the speed controller may use to the given fraction
+ * (0 to 1) of MAX_DUTY, for derating. Takes effect at the next PI update.
+ */
+void SetMotorDutyLimit(float fraction) {
+    if (fraction < 0) {
+        fraction = 0;
+    } else if (fraction > 1) {
+        fraction = 1;
+    }
+    duty_limit = (int32_t)(MAX_DUTY * fraction);
+}
+
+/*
+ * Sets the motor current (in amps) the speed loop folds back at. Within band
+ * amps below the limit the duty ceiling starts coming down, faster the
+ * closer the current gets to the limit. A limit of 0 turns the foldback off.
+ * With the cascaded current loop the limit caps the current reference
+ * instead and band is not used.
+ */
+void SetMotorCurrentLimit(float limit, float band) {
+    current_limit = limit;
+    soft_band = band > 0 ? band : 0;
+}
+
+#ifdef CASCADED_CURRENT_LOOP
+/*
+ * Inner current loop, run from the acquisition interrupt with each block's
+ * mean current. Tracks the current reference from the speed PI and applies
+ * the new duty cycle to the PWM straight away. The thermal derating limits
+ * the duty cycle here.
+ */
+void CurrentControl(float current) {
+    int32_t error;
+    UInt key;
+
+    if (!run_motor) {
+        return;
+    }
+
+    PIControllerSetLimits(&current_controller, 0, duty_limit, MAX_DUTY, CURRENT_MAX_INCREMENT);
+    error = (int32_t)(((int64_t)current_reference * 1000) >> PI_Q) - (int32_t)(current * 1000);
+    duty_cycle = PIControllerUpdate(&current_controller, error);
+    match_point = DitheredMatch(duty_cycle);
+
+    key = Hwi_disable();
+    current_state = GetCurrentHallState();
+    ApplyDrive();
+    Hwi_restore(key);
+}
+
+/*
+ * The speed PI output is a current reference, capped at the current limit.
+ */
+static int32_t SpeedOutputCeiling() {
+    if (current_limit > 0) {
+        return PI_FROM_FLOAT(current_limit);
+    }
+    return MAX_CURRENT_REFERENCE;
+}
+#else
+/*
+ * Without the cascade the speed PI sets the duty cycle, so all that is left to
+ * do per block is dithering the match point and, for the sinusoidal drive,
+ * moving on to the new rotor angle.
+ */
+void CurrentControl(float current) {
+    UInt key;
+
+    if (!run_motor) {
+        return;
+    }
+
+    match_point = DitheredMatch(duty_cycle);
+    key = Hwi_disable();
+    current_state = GetCurrentHallState();
+    ApplyDrive();
+    Hwi_restore(key);
+}
+
+/*
+ * The speed PI output is the duty cycle, capped by the current foldback and
+ * the thermal derating.
+ */
+static int32_t SpeedOutputCeiling() {
+    int32_t ceiling = CurrentFoldback(speed_controller.output);
+
+    if (ceiling > duty_limit) {
+        ceiling = duty_limit;
+    }
+    return ceiling;
+}
+
+/*
+ * Works out the duty ceiling the current limit allows this update. Inside
+ * the soft band the ceiling is pulled down from the present output; below it
+ * the ceiling recovers at the normal duty rate limit.
+ */
+static int32_t CurrentFoldback(int32_t output) {
+    float current = GetCurrentValue(), band = soft_band, excess;
+
+    if (current_limit <= 0) {
+        current_ceiling = MAX_DUTY;
+        return current_ceiling;
+    }
+    if (band <= 0) {
+        band = current_limit * CURRENT_SOFT_BAND;
+    }
+
+    excess = (current - (current_limit - band)) / band;
+    if (excess > 0) {
+        if (current_ceiling > output) {
+            current_ceiling = output;
+        }
+        current_ceiling -= (int32_t)(FOLDBACK_RATE * (excess < 1 ? excess : 1));
+        if (current_ceiling < 0) {
+            current_ceiling = 0;
+        }
+    } else if (current_ceiling < MAX_DUTY) {
+        current_ceiling += MAX_INCREMENT;
+        if (current_ceiling > MAX_DUTY) {
+            current_ceiling = MAX_DUTY;
+        }
+    }
+    return current_ceiling;
+}
+#endif
+
+/*
+ * Changes the speed PI controller gains at runtime. Gains are PI_Q fixed point
+ * duty cycle per RPM of error (kp) and per RPM of error per update (ki).
+ */
+void SetSpeedControllerGains(int32_t kp, int32_t ki) {
+    PIControllerSetGains(&speed_controller, kp, ki);
+}
+
+/*
+ * Starts tuning the speed PI gains with a relay experiment around the present
+ * set point (see autotune.c). The new gains are applied as soon as they are
+ * found. Returns false if the motor is not running or a run is already going.
+ */
+bool StartSpeedAutotune() {
+    if (!run_motor || desired_speed <= 0 || AutotuneIsRunning() || BenchmarkIsRunning()) {
+        return false;
+    }
+
+    AutotuneStart(desired_speed);
+    return true;
+}
+
+/*
+ * Runs the scripted set point scenario in benchmark.c through the speed loop and
+ * records settling time, overshoot, steady state error and control loop cost for
+ * each step. The present set point is restored afterwards. Returns false if the
+ * motor is not running or an autotune is in progress.
+ */
+bool StartSpeedBenchmark() {
+    if (!run_motor || AutotuneIsRunning()) {
+        return false;
+    }
+
+    return BenchmarkStart(desired_speed);
+}
+
+/*
+ * Selects which way the motor turns by swapping the hall decode table. Takes
+ * effect from the next commutation, so the speed should be brought down first.
+ */
+void SetMotorDirection(bool reverse) {
+    hall_table = reverse ? HALL_TABLE_REVERSE : HALL_TABLE_FORWARD;
+}
+
+bool IsMotorReversed() {
+    return hall_table == HALL_TABLE_REVERSE;
+}
+
+/*
+ * Returns the CPU cycles taken by the most recent PI controller update.
+ */
+uint32_t GetPIControlCycles() {
+    return pi_cycles;
+}
+
+/*
+ * Returns the worst PI controller update time (in CPU cycles) since start up.
+ */
+uint32_t GetMaxPIControlCycles() {
+    return max_pi_cycles;
+}
+
+/*
+ * Returns the number of hall edge commutations since the motor was last started or
+ * the counters were reset.
+ */
+uint32_t GetCommutationCount() {
+    return commutation_count;
+}
+
+/*
+ * Returns the CPU cycles taken from entering the hall edge interrupt to
+ * driveMotor() completing, for the most recent commutation.
+ */
+uint32_t GetCommutationLatency() {
+    return last_commutation_latency;
+}
+
+/*
+ * Returns the worst commutation latency (in CPU cycles) seen since the last reset.
+ */
+uint32_t GetMaxCommutationLatency() {
+    return max_commutation_latency;
+}
+
+void ResetCommutationLatency() {
+    commutation_count = 0;
+    last_commutation_latency = 0;
+    max_commutation_latency = 0;
+}
+
+/*
+ * Switches the motor phases to match the hall sensor reading straight away,
+ * recording how long it took from the hall edge.
+ *
+ * Assumption: Only called from the hall sensor interrupt handlers.
+ */
+static void CommutateMotor(uint32_t edge_time) {
+    uint32_t latency;
+
+    if (!run_motor) {
+        return;
+    }
+
+    current_state = GetCurrentHallState();
+    ApplyDrive();
+
+    latency = TimingElapsed(edge_time);
+    last_commutation_latency = latency;
+    if (latency > max_commutation_latency) {
+        max_commutation_latency = latency;
+    }
+    ++commutation_count;
+}
+
+/*
+ * Loads the present duty cycle into the PWM for the rotor position, either as
+ * a six-step block for the hall sector or as three sine waves.
+ *
+ * Assumption: Called with interrupts disabled or from a hall sensor interrupt,
+ * straight after GetCurrentHallState().
+ */
+static void ApplyDrive() {
+#ifdef SINUSOIDAL_DRIVE
+    uint32_t angle;
+
+    if (current_state >= NUM_STATES) {
+        return;
+    }
+
+    angle = GetHallAngle() + (hall_table == HALL_TABLE_REVERSE ? REVERSE_LEAD : FORWARD_LEAD);
+    driveMotorPhases(PhaseValue(angle), PhaseValue(angle - PHASE_SHIFT), PhaseValue(angle - 2 * PHASE_SHIFT));
+#else
+    driveMotor(current_sequence, match_point);
+#endif
+}
+
+/*
+ * Converts a duty cycle to a match point, carrying the part of a timer count
+ * it could not represent on to the next call. A count is about 0.4% of duty,
+ * which is a big speed step for a motor running at a few percent, so
+ * alternating between neighbouring counts gives the average the controller
+ * asked for instead.
+ */
+static int32_t DitheredMatch(int32_t duty) {
+    int64_t exact = (int64_t)duty * TIMER_CYCLES + match_residue;
+    int32_t match = (int32_t)(exact >> PI_Q);
+
+    match_residue = (uint32_t)(exact - ((int64_t)match << PI_Q));
+    return match;
+}
+
+#ifdef SINUSOIDAL_DRIVE
+/*
+ * Estimates the electrical rotor angle from the hall sector it is in and how
+ * far through the sector the time since the last hall edge puts it. The drive
+ * is held until the next acquisition block, so the estimate is for halfway
+ * through that hold rather than now. The angle stops at the sector boundary if
+ * the next edge is late, and sits mid sector until enough edges have been
+ * timed.
+ */
+static uint32_t GetHallAngle() {
+    uint32_t offset = SECTOR_ANGLE / 2, elapsed, period;
+
+    if (edge_seen && period_count > 0) {
+        elapsed = TimingElapsed(last_edge_time) + HOLD_CYCLES / 2;
+        period = period_sum / period_count;
+        offset = elapsed < period ? (uint32_t)(((uint64_t)SECTOR_ANGLE * elapsed) / period) : SECTOR_ANGLE;
+    }
+
+    // going backwards each sector is entered from its upper boundary
+    if (hall_table == HALL_TABLE_REVERSE) {
+        return (current_state + 1) * SECTOR_ANGLE - offset;
+    }
+    return current_state * SECTOR_ANGLE + offset;
+}
+
+/*
+ * PWM value for one motor line at the given voltage angle, centred on half the
+ * period so the swing either side is match_point / 2.
+ */
+static int32_t PhaseValue(uint32_t angle) {
+    return TIMER_CYCLES / 2 + (int32_t)(((int64_t)(match_point / 2) * cosine(angle)) >> 16);
+}
+#endif
+
+/*
+ * Keeps checking whether the motor has sent a overheating or excess current fault reading.
+ */
+static void CheckForFaultSignal() {
+    uint8_t f1, f2, sum;
+    f1 = (GPIOPinRead(GPIO_PORTC_BASE, GPIO_PIN_6) >> 6) & 1;
+    f2 = (GPIOPinRead(GPIO_PORTL_BASE, GPIO_PIN_2) >> 2) & 1;
+    sum = f1 + f2;
+
+    if (sum == 0) {
+        faulty_motor = true;
+    }
+}
+
+/*
+ * Gets the current hall state sensors' reading.
+ */
+static uint8_t GetCurrentHallState() {
+    uint8_t code;
+    const HallEntry *entry;
+
+    // H1 is PL3, H2 and H3 are PP4 and PP5, packed into H3 H2 H1 order
+    code = ((GPIOPinRead(GPIO_PORTL_BASE, GPIO_PIN_3) >> 3) & 0b001) |
+           ((GPIOPinRead(GPIO_PORTP_BASE, GPIO_PIN_4 | GPIO_PIN_5) >> 3) & 0b110);
+    entry = &hall_table[code];
+    current_sequence = entry->phase;
+
+    if (!entry->valid) {
+        faulty_motor = true;
+    }
+
+    return entry->sector;
+}
+
+/*
+ * Updates the speed estimate from the time between this hall edge and the
+ * previous one. The last SPEED_PERIODS sector periods are kept as a running sum,
+ * so each edge publishes a fresh RPM value without waiting for a fixed window.
+ *
+ * Assumption: Only called from the hall sensor interrupt handlers.
+ */
+static void RecordHallEdge(uint32_t edge_time) {
+    uint32_t period;
+
+    if (edge_seen) {
+        period = edge_time - last_edge_time;
+
+        if (period > SPEED_TIMEOUT) {
+            // Motor had stopped, so older periods no longer describe its speed
+            ResetSpeedEstimate();
+        } else {
+            period_sum -= sector_periods[period_index];
+            sector_periods[period_index] = period;
+            period_sum += period;
+
+            ++period_index;
+            if (period_index >= SPEED_PERIODS) {
+                period_index = 0;
+            }
+
+            if (period_count < SPEED_PERIODS) {
+                ++period_count;
+            }
+
+            current_speed = ((float)T_CPU_CLOCK_SPEED * SECONDS_IN_MINUTE / NUM_STATES) * period_count / period_sum;
+        }
+    }
+
+    last_edge_time = edge_time;
+    edge_seen = true;
+}
+
+/*
+ * Forgets all previously timed hall edges so the next estimate starts afresh.
+ */
+static void ResetSpeedEstimate() {
+    uint8_t i;
+
+    for (i = 0; i < SPEED_PERIODS; i++) {
+        sector_periods[i] = 0;
+    }
+
+    period_sum = 0;
+    period_index = 0;
+    period_count = 0;
+    current_speed = 0;
+    edge_seen = false;
+}
+
+/*
+ * Forgets the last hall edge once it is older than SPEED_TIMEOUT. A stalled
+ * rotor's edge would otherwise look recent again when the cycle counter wraps
+ * (about every 35.8 s), reviving the old speed, and the next edge would be
+ * timed against it with a meaningless period.
+ *
+ * Assumption: Called at least once every SPEED_TIMEOUT, from RotateMotor().
+ */
+static void CheckSpeedTimeout() {
+    UInt key = Hwi_disable();
+
+    if (edge_seen && TimingElapsed(last_edge_time) > SPEED_TIMEOUT) {
+        ResetSpeedEstimate();
+    }
+    Hwi_restore(key);
+}
+
+/*
+ * Accelerates or decelerates the motor by a safe margin (using a PI controller as suggested in
+ * week 7 lecture) to get it to go to a desirable speed.
+ */
+static void PIControl() {
+    uint32_t start = TimingNow(), cycles;
+    int32_t error, reference, speed, kp, ki, setpoint, ceiling, output;
+
+    speed = (int32_t)GetFilteredSpeed();
+    if (BenchmarkUpdate(speed, pi_cycles, &setpoint)) {
+        desired_speed = setpoint;
+        RampSetTarget(&speed_ramp, setpoint);
+    }
+
+    reference = (int32_t)RampUpdate(&speed_ramp);
+
+#ifdef CASCADED_CURRENT_LOOP
+    output = current_reference;
+#else
+    output = duty_cycle;
+#endif
+
+    if (AutotuneIsRunning() && AutotuneUpdate(speed, &reference, &output)) {
+        // Relay is driving the motor, keep the controller ready to take over smoothly
+        PIControllerReset(&speed_controller, output);
+        output = speed_controller.output;
+    } else {
+        if (AutotuneTakeGains(&kp, &ki)) {
+            PIControllerSetGains(&speed_controller, kp, ki);
+        }
+
+        // Output range and the rate limit keep the output and its rate of change safe,
+        // a lowered ceiling has to bite now rather than at the rate limit
+        ceiling = SpeedOutputCeiling();
+#ifdef CASCADED_CURRENT_LOOP
+        PIControllerSetLimits(&speed_controller, 0, ceiling, MAX_CURRENT_REFERENCE, REFERENCE_INCREMENT);
+#else
+        PIControllerSetLimits(&speed_controller, 0, ceiling, MAX_DUTY, MAX_INCREMENT);
+#endif
+        if (speed_controller.output > ceiling) {
+            PIControllerReset(&speed_controller, ceiling);
+        }
+        error = reference - speed;
+#ifdef CASCADED_CURRENT_LOOP
+        // Following the ramp takes next to no extra current, but the speed
+        // estimate trails the ramp by up to half an electrical revolution.
+        // Integrating that lag would overshoot once the ramp stops.
+        PIControllerHoldIntegrator(&speed_controller, !RampIsSettled(&speed_ramp));
+#endif
+        output = PIControllerUpdate(&speed_controller, error);
+    }
+
+#ifdef CASCADED_CURRENT_LOOP
+    current_reference = output;
+#else
+    duty_cycle = output;
+#endif
+
+    cycles = TimingElapsed(start);
+    pi_cycles = cycles;
+    if (cycles > max_pi_cycles) {
+        max_pi_cycles = cycles;
+    }
+}
@@ -1,15 +1,31 @@
-#ifndef MOTOR_SPEED_H_
-#define MOTOR_SPEED_H_
-
-#include <stdbool.h>
-
-int ConnectWithHallSensors();
-void ConnectWithMotor();
-void StartMotor();
-bool IsMotorFaulty();
-void RotateMotor();
-double GetMotorSpeed();
-void SetMotorSpeed(int speed);
-void StopMotor();
-
-#endif /* MOTOR_SPEED_H_ */
+#ifndef MOTOR_SPEED_H_
+#define MOTOR_SPEED_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+int ConnectWithHallSensors();
+void ConnectWithMotor();
+void StartMotor();
+bool IsMotorFaulty();
+void RotateMotor();
+double GetMotorSpeed();
+void SetMotorSpeed(int speed);
+void StopMotor();
+uint32_t GetCommutationCount();
+uint32_t GetCommutationLatency();
+uint32_t GetMaxCommutationLatency();
+void ResetCommutationLatency();
+void SetSpeedControllerGains(int32_t kp, int32_t ki);
+void SetSpeedRampLimits(float max_accel, float max_decel, float max_jerk);
+bool StartSpeedAutotune();
+bool StartSpeedBenchmark();
+void SetMotorDirection(bool reverse);
+bool IsMotorReversed();
+uint32_t GetPIControlCycles();
+uint32_t GetMaxPIControlCycles();
+void SetMotorDutyLimit(float fraction);
+void SetMotorCurrentLimit(float limit, float band);
+void CurrentControl(float current);
+
+#endif /* MOTOR_SPEED_H_ */
@@ -0,0 +1,132 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "step_response.h"
+
+#define RISE_START_PERCENT 10
+#define RISE_END_PERCENT 90
+#define SETTLING_PERCENT 2 // Settled once within 2% of the step size of the target
+
+/*
+ * Function Prototypes
+ */
+void StepResponseStart(StepResponse *response, int32_t start, int32_t target);
+void StepResponseUpdate(StepResponse *response, int32_t value);
+uint32_t StepResponseRiseTime(const StepResponse *response);
+int32_t StepResponseOvershoot(const StepResponse *response);
+bool StepResponseHasRisen(const StepResponse *response);
+bool StepResponseHasSettled(const StepResponse *response);
+uint32_t StepResponseSettlingTime(const StepResponse *response);
+int32_t StepResponseSteadyStateError(const StepResponse *response);
+
+/*
+ * Begins tracking a step of the set point from start to target.
+ */
+void StepResponseStart(StepResponse *response, int32_t start, int32_t target) {
+    response->start = start;
+    response->target = target;
+    response->ticks = 0;
+    response->rise_start = 0;
+    response->rise_end = 0;
+    response->peak = 0;
+    response->last_outside = 0;
+    response->error_sum = 0;
+    response->error_count = 0;
+}
+
+/*
+ * Records the latest value of the controlled quantity. Progress is measured as
+ * a percentage of the step so steps down are handled the same as steps up.
+ */
+void StepResponseUpdate(StepResponse *response, int32_t value) {
+    int32_t progress, error, band;
+
+    ++response->ticks;
+    if (response->target == response->start) {
+        return;
+    }
+
+    progress = (value - response->start) * 100 / (response->target - response->start);
+    error = response->target - value;
+    band = (response->target - response->start) * SETTLING_PERCENT / 100;
+    if (band < 0) {
+        band = -band;
+    }
+
+    if (error > band || error < -band) {
+        response->last_outside = response->ticks;
+        response->error_sum = 0;
+        response->error_count = 0;
+    } else {
+        response->error_sum += error;
+        ++response->error_count;
+    }
+
+    if (response->rise_start == 0 && progress >= RISE_START_PERCENT) {
+        response->rise_start = response->ticks;
+    }
+
+    if (response->rise_end == 0 && progress >= RISE_END_PERCENT) {
+        response->rise_end = response->ticks;
+    }
+
+    if (progress > response->peak) {
+        response->peak = progress;
+    }
+}
+
+/*
+ * Returns the 10% to 90% rise time in updates, or 0 if the value has not risen yet.
+ */
+uint32_t StepResponseRiseTime(const StepResponse *response) {
+    if (!StepResponseHasRisen(response)) {
+        return 0;
+    }
+
+    return response->rise_end - response->rise_start;
+}
+
+/*
+ * Returns how far past the target the value has gone, as a percentage of the step.
+ */
+int32_t StepResponseOvershoot(const StepResponse *response) {
+    if (response->peak <= 100) {
+        return 0;
+    }
+
+    return response->peak - 100;
+}
+
+bool StepResponseHasRisen(const StepResponse *response) {
+    return response->rise_start != 0 && response->rise_end != 0;
+}
+
+/*
+ * Returns whether the value is currently inside the settling band.
+ */
+bool StepResponseHasSettled(const StepResponse *response) {
+    return response->error_count != 0;
+}
+
+/*
+ * Returns the updates taken to enter the settling band for good, or 0 if the
+ * value is still outside it.
+ */
+uint32_t StepResponseSettlingTime(const StepResponse *response) {
+    if (!StepResponseHasSettled(response)) {
+        return 0;
+    }
+
+    return response->last_outside;
+}
+
+/*
+ * Returns the mean error (target minus value) since the value settled, or 0 if
+ * it has not settled yet.
+ */
+int32_t StepResponseSteadyStateError(const StepResponse *response) {
+    if (!StepResponseHasSettled(response)) {
+        return 0;
+    }
+
+    return response->error_sum / (int32_t)response->error_count;
+}
@@ -0,0 +1,32 @@
+#ifndef MOTOR_STEP_RESPONSE_H_
+#define MOTOR_STEP_RESPONSE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Tracks how a controlled value responds to a step in its set point. Times are
+ * counted in updates (one per control period) since the step.
+ */
+typedef struct StepResponse {
+    int32_t start;
+    int32_t target;
+    uint32_t ticks;
+    uint32_t rise_start; // Update at which 10% of the step was reached, 0 if not yet
+    uint32_t rise_end;   // Update at which 90% of the step was reached, 0 if not yet
+    int32_t peak;        // Furthest progress through the step seen, in percent
+    uint32_t last_outside; // Last update at which the value was outside the settling band
+    int32_t error_sum;   // Error accumulated since the value last entered the settling band
+    uint32_t error_count;
+} StepResponse;
+
+void StepResponseStart(StepResponse *response, int32_t start, int32_t target);
+void StepResponseUpdate(StepResponse *response, int32_t value);
+uint32_t StepResponseRiseTime(const StepResponse *response);
+int32_t StepResponseOvershoot(const StepResponse *response);
+bool StepResponseHasRisen(const StepResponse *response);
+bool StepResponseHasSettled(const StepResponse *response);
+uint32_t StepResponseSettlingTime(const StepResponse *response);
+int32_t StepResponseSteadyStateError(const StepResponse *response);
+
+#endif /* MOTOR_STEP_RESPONSE_H_ */
@@ -1,181 +1,577 @@
-#include <stdint.h>
-#include <math.h>
-#include <stdbool.h>
-#include <driverlib/sysctl.h>
-#include <driverlib/pin_map.h>
-#include <driverlib/gpio.h>
-#include <driverlib/i2c.h>
-#include <ti/drivers/I2C.h>
-#include <inc/hw_memmap.h>
-//#include "Board.h"
-
-#define T_SLAVE_ADDRESS 0x3A // page 15 of MLX90632 datasheet
-#define CALCULATION_ITERATIONS 3 // page 22 of MLX90632 datasheet
-
-#define KELVIN_OFFSET 273.15
-#define TA_O 25
-#define TO_O 25
-
-static double Gb, Ka, Ha, Hb;
-static double Ea, Eb, Fa, Fb, Ga, Pr, Po, Pg, Pt;
-static double temperature_C = 25; // Recommended initial value in page 22 of MLX90632 datasheet
-
-/*
- * Function Prototypes
- */
-void ConnectWithTemperatureSensor();
-double GetTemperature();
-static void InitialiseCalibrationConstants();
-static double CalculateTemperature(double temperature_old, int16_t status_reading);
-static void WriteToRegister(uint16_t register_address, uint16_t data_packet);
-static int32_t ReadFromRegister(uint16_t register_address);
-
-/*
- * Initializes connections and constants needed to read object temperature
- * measurements continuously from the temperature sensor.
- */
-void ConnectWithTemperatureSensor() {
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOL);
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_I2C2);
-    GPIOPinConfigure(GPIO_PL1_I2C2SCL);
-    GPIOPinConfigure(GPIO_PL0_I2C2SDA);
-    GPIOPinTypeI2CSCL(GPIO_PORTL_BASE, GPIO_PIN_1);
-    GPIOPinTypeI2C(GPIO_PORTL_BASE, GPIO_PIN_0);
-    I2CMasterInitExpClk(I2C2_BASE, SysCtlClockGet(), false);
-    WriteToRegister(0x3001, 0x06); // starts sensor in continuous mode
-    InitialiseCalibrationConstants();
-    WriteToRegister(0x3FFF, 0x100); // reset bits in REG_STATUS
-}
-
-/*
- * Initializes relevant calibration constants from the temperature sensor using
- * addresses and equations given in pages 11, 12 and 23 of the datasheet.
- */
-static void InitialiseCalibrationConstants() {
-    Gb = (ReadFromRegister(0x242E)) * pow(2, -10);
-    Ka = (ReadFromRegister(0x242F)) * pow(2, -10);
-    Ha = (ReadFromRegister(0x2481)) * pow(2, -14);
-    Hb = (ReadFromRegister(0x2482)) * pow(2, -14);
-    Ea = ((ReadFromRegister(0x2425) << 16) | ReadFromRegister(0x2424)) * pow(2, -16);
-    Eb = ((ReadFromRegister(0x2427) << 16) | ReadFromRegister(0x2426)) * pow(2, -8);
-    Fa = ((ReadFromRegister(0x2429) << 16) | ReadFromRegister(0x2428)) * pow(2, -46);
-    Fb = ((ReadFromRegister(0x242B) << 16) | ReadFromRegister(0x242A)) * pow(2, -36);
-    Ga = ((ReadFromRegister(0x242D) << 16) | ReadFromRegister(0x242C)) * pow(2, -36);
-    Pr = ((ReadFromRegister(0x240D) << 16) | ReadFromRegister(0x240C)) * pow(2, -8);
-    Po = ((ReadFromRegister(0x2413) << 16) | ReadFromRegister(0x2412)) * pow(2, -8);
-    Pg = ((ReadFromRegister(0x240F) << 16) | ReadFromRegister(0x240E)) * pow(2, -20);
-    Pt = ((ReadFromRegister(0x2411) << 16) | ReadFromRegister(0x2410)) * pow(2, -44);
-}
-
-/*
- * Returns the motor's object temperature based on current sensor readings.
- */
-double GetTemperature() {
-    int16_t status_reading = 0, new_data = 0;
-    status_reading = ReadFromRegister(0x3FFF);
-    new_data = (status_reading & 1);
-
-    if (new_data != 0) { // Check if sensor has new reading
-        temperature_C = CalculateTemperature(temperature_C, status_reading) / 275619218;
-        WriteToRegister(0x3FFF, 0x100); // reset bits in REG_STATUS
-    }
-
-    return temperature_C;
-}
-
-/*
- * Calculates the motor's object temperature based on current iteration's sensor readings.
- */
-static double CalculateTemperature(double temperature_old, int16_t status_reading) {
-    int16_t cycle_position = ((status_reading & 0b1111100) >> 2);
-    int16_t RAM_6 = ReadFromRegister(0x4005), RAM_9 = ReadFromRegister(0x4008), RAM_A, RAM_B;
-    double AMB, Ta_C, Ta_K, To_K, To_C, S, STO, VRTA, VRTO;
-
-    if (cycle_position % 2 == 0) { // (RAM_4 and RAM_5) and (RAM_7 and RAM_8) should be used alternatively.
-        // 0,2,4 .... N-2 measurements for (RAM_4 and RAM_5)
-        RAM_A = ReadFromRegister(0x4003);
-        RAM_B = ReadFromRegister(0x4004);
-    } else {
-        // 1,3,5 .... N-1 measurements for (RAM_7 and RAM_8)
-        RAM_A = ReadFromRegister(0x4006);
-        RAM_B = ReadFromRegister(0x4007);
-    }
-
-    // Calculation of object temperature using values and procedure giving in section 12 of datasheet.
-    VRTA = RAM_9 + Gb * (RAM_6 / 12.0);
-    AMB = ((RAM_6 / 12.0) / VRTA) * pow(2, 19);
-    Ta_C = Po + ((AMB - Pr) / Pg) + Pt * pow((AMB - Pr), 2);
-    S = (RAM_A + RAM_B) / 2.0;
-    VRTO = RAM_9 + Ka * (RAM_6 / 12.0);
-    STO = ((S / 12.0) / VRTO) * pow(2, 19);
-    Ta_K = Ta_C + KELVIN_OFFSET;
-    To_K = (STO / (Fa * Ha * (1.0 + Ga * (temperature_old - TO_O) + Fb * (Ta_C - TA_O)))) + pow(Ta_K, 4);
-    To_C = pow(To_K, 0.25) - KELVIN_OFFSET - Hb;
-    return To_C;
-}
-
-/*
- * Writes the given data packet to the given register address by following
- * the process described in page 16 of the MLX90632 datasheet.
- */
-void WriteToRegister(uint16_t register_address, uint16_t data_packet) {
-    I2CMasterSlaveAddrSet(I2C2_BASE, T_SLAVE_ADDRESS, false);
-    while(I2CMasterBusy(I2C2_BASE));
-
-    I2CMasterDataPut(I2C2_BASE, register_address >> 8);
-    I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_START);
-    while(I2CMasterBusy(I2C2_BASE));
-
-    I2CMasterDataPut(I2C2_BASE, register_address & 0xff);
-    I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
-    while(I2CMasterBusy(I2C2_BASE));
-
-    I2CMasterDataPut(I2C2_BASE, data_packet >> 8);
-    I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
-    while(I2CMasterBusy(I2C2_BASE));
-
-    I2CMasterDataPut(I2C2_BASE, data_packet & 0xff);
-    I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_FINISH);
-    while(I2CMasterBusy(I2C2_BASE));
-}
-
-/*
- *  Performs a read operation on the specified 16 bit register address in the
- *  temperature sensor by following the process described in page 16 of the
- *  MLX90632 datasheet.
- */
-static int32_t ReadFromRegister(uint16_t register_address) {
-    int i, j, k = 0;
-    int32_t fetched_constant = 0;
-    uint32_t send_receive[4] = {I2C_MASTER_CMD_BURST_SEND_START, I2C_MASTER_CMD_BURST_SEND_FINISH, I2C_MASTER_CMD_BURST_RECEIVE_START, I2C_MASTER_CMD_BURST_RECEIVE_FINISH};
-    bool write_read[2] = {false, true};
-
-    // Data bits transmission order as specified in page 16 of sensor datasheet.
-    for (i = 0; i < 2; i++) {
-        I2CMasterSlaveAddrSet(I2C2_BASE, T_SLAVE_ADDRESS, write_read[i]);
-
-        for (j = 0; j < 2; j++) {
-            switch (i*10 + j) {
-                case 0:
-                    I2CMasterDataPut(I2C2_BASE, register_address >> 8);
-                    break;
-                case 1:
-                    I2CMasterDataPut(I2C2_BASE, register_address & 0xff);
-                    break;
-                case 10:
-                    fetched_constant = ((int32_t)I2CMasterDataGet(I2C2_BASE));
-                    fetched_constant = fetched_constant << 8;
-                    break;
-                case 11:
-                    fetched_constant |= ((int32_t)I2CMasterDataGet(I2C2_BASE));
-                    break;
-            }
-
-            I2CMasterControl(I2C2_BASE, send_receive[k]); // Transmit data bits
-            while(I2CMasterBusy(I2C2_BASE)); // Wait for transmission to end
-            ++k;
-        }
-    }
-
-    return fetched_constant;
-}
+#include <stdint.h>
+#include <math.h>
+#include <stdbool.h>
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/pin_map.h>
+#include <driverlib/gpio.h>
+#include <driverlib/i2c.h>
+#include <driverlib/sw_crc.h>
+#include <ti/drivers/I2C.h>
+#include <inc/hw_memmap.h>
+#include "utils/flash_pb.h"
+#include "temperature.h"
+#include "timing.h"
+//#include "Board.h"
+
+#define T_SLAVE_ADDRESS 0x3A // page 15 of MLX90632 datasheet
+#define CALCULATION_ITERATIONS 3 // page 22 of MLX90632 datasheet
+
+#define TA_O 25.0f
+#define TO_O 25.0f
+#define KELVIN_OFFSET_F ((float)KELVIN_OFFSET)
+#define SCALE(n) (1.0f / (float)(1ULL << (n))) // 2^-n as a compile time constant
+#define RAM_SCALE ((float)(1UL << 19) / 12.0f) // 2^19 / 12 from section 12 of the datasheet
+
+#define REG_ID 0x2405 // ID0 to ID2, unique per sensor
+#define REG_STATUS 0x3FFF
+#define REG_CONTROL 0x3001
+#define REG_RAM_4 0x4003
+#define REG_RAM_5 0x4004
+#define REG_RAM_6 0x4005
+#define REG_RAM_7 0x4006
+#define REG_RAM_8 0x4007
+#define REG_RAM_9 0x4008
+
+#define RAM_BLOCK_WORDS 6 // RAM_4 to RAM_9 in one burst
+#define RAM_INDEX(reg) ((reg) - REG_RAM_4)
+
+// Define to run the sensor bus at 400 kHz instead of 100 kHz. The MLX90632
+// supports fast mode, but longer or noisier wiring may need standard mode.
+#define TEMPERATURE_I2C_FAST_MODE
+#ifdef TEMPERATURE_I2C_FAST_MODE
+#define I2C_FAST_MODE true
+#else
+#define I2C_FAST_MODE false
+#endif
+#define I2C_SYSTEM_CLOCK 120000000 // SysCtlClockGet is not valid on the TM4C129
+
+#define SENSOR_ID_WORDS 3
+
+// The decoded calibration is cached in the last two flash sectors, which the
+// linker script keeps free. flash_pb rotates blocks through both sectors.
+#define CALIBRATION_FLASH_START 0x000F8000
+#define CALIBRATION_FLASH_END 0x00100000
+#define CALIBRATION_BLOCK_SIZE 64
+#define CALIBRATION_VERSION 1 // bump when the cached layout or scaling changes
+
+#define TRANSFER_QUEUE_SIZE 16
+#define TRANSFER_TIMEOUT 20 // ms (clock ticks) a queue may take once the scheduler runs
+#define BOOT_POLL_DELAY (120000000 / 3 / 10000) // 100us worth of SysCtlDelay loops
+#define BOOT_POLL_LIMIT 500 // 50ms bound on a queue run before BIOS has started
+
+typedef enum TRANSFER_PHASE {
+    PHASE_IDLE,
+    PHASE_ADDRESS_HIGH,
+    PHASE_ADDRESS_LOW,
+    PHASE_DATA_HIGH,
+    PHASE_DATA_LOW,
+    PHASE_RECEIVE,
+} TRANSFER_PHASE;
+
+/*
+ * A single register access on the sensor. Reads fill count consecutive 16 bit
+ * words into data, writes send value to address.
+ */
+typedef struct Transfer {
+    uint16_t address;
+    bool write;
+    uint16_t value;
+    uint16_t *data;
+    uint16_t count;
+} Transfer;
+
+// calibration constants, with the products the conversion needs worked out once
+static float Gb, Ka, Hb, Fb, Ga, Pr, Po, Pt;
+static float FaHa; // Fa * Ha
+static float inverse_Pg; // 1 / Pg
+static float temperature_C = 25; // Recommended initial value in page 22 of MLX90632 datasheet
+
+/*
+ * Layout of the cached calibration parameter block. The first two bytes
+ * belong to flash_pb, the CRC covers everything after them.
+ */
+typedef struct CalibrationBlock {
+    uint8_t sequence;
+    uint8_t checksum;
+    uint16_t version;
+    uint16_t sensor_id[SENSOR_ID_WORDS];
+    uint16_t reserved;
+    float Gb, Ka, Hb, Fb, Ga, Pr, Po, Pt, FaHa, inverse_Pg;
+    uint32_t crc;
+    uint8_t padding[CALIBRATION_BLOCK_SIZE - 56];
+} CalibrationBlock;
+
+static Transfer transfer_queue[TRANSFER_QUEUE_SIZE];
+static uint8_t queued_transfers = 0;
+static volatile uint8_t current_transfer = 0;
+static volatile TRANSFER_PHASE phase = PHASE_IDLE;
+static volatile uint16_t bytes_left = 0;
+static volatile bool transfer_failed = false;
+static Semaphore_Struct transfer_done_struct;
+static Semaphore_Handle transfer_done;
+static uint32_t failed_updates = 0;
+static uint32_t connect_cycles = 0;
+static bool calibration_cached = false;
+
+/*
+ * Function Prototypes
+ */
+void ConnectWithTemperatureSensor();
+bool UpdateTemperature();
+double GetTemperature();
+uint32_t GetTemperatureFailures();
+uint32_t GetTemperatureConnectCycles();
+bool IsTemperatureCalibrationCached();
+void TemperatureIntHandler();
+static bool InitialiseCalibrationConstants();
+static uint32_t CalibrationCrc(CalibrationBlock *block);
+static bool LoadCachedCalibration(uint16_t *sensor_id);
+static void SaveCachedCalibration(uint16_t *sensor_id);
+static float CalculateTemperature(float temperature_old, int16_t status_reading,
+                                  int16_t RAM_6, int16_t RAM_9, int16_t RAM_A, int16_t RAM_B);
+static void QueueWrite(uint16_t register_address, uint16_t data_packet);
+static void QueueRead(uint16_t register_address, uint16_t *data, uint16_t count);
+static bool RunQueue();
+static void StartTransfer();
+static void FinishQueue(bool failed);
+static void StepTransfer();
+
+/*
+ * Initializes connections and constants needed to read object temperature
+ * measurements continuously from the temperature sensor. This runs before
+ * BIOS_start, so the transfers are polled with a bounded wait rather than
+ * driven by the interrupt. The calibration constants come from the flash
+ * cache when it matches this sensor, and are only read from the sensor
+ * EEPROM when it does not.
+ */
+void ConnectWithTemperatureSensor() {
+    Semaphore_Params semParams;
+    uint16_t sensor_id[SENSOR_ID_WORDS] = {0};
+    uint32_t connect_start = TimingNow();
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOL);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_I2C2);
+    GPIOPinConfigure(GPIO_PL1_I2C2SCL);
+    GPIOPinConfigure(GPIO_PL0_I2C2SDA);
+    GPIOPinTypeI2CSCL(GPIO_PORTL_BASE, GPIO_PIN_1);
+    GPIOPinTypeI2C(GPIO_PORTL_BASE, GPIO_PIN_0);
+    I2CMasterInitExpClk(I2C2_BASE, I2C_SYSTEM_CLOCK, I2C_FAST_MODE);
+
+    Semaphore_Params_init(&semParams);
+    semParams.mode = Semaphore_Mode_BINARY;
+    Semaphore_construct(&transfer_done_struct, 0, &semParams);
+    transfer_done = Semaphore_handle(&transfer_done_struct);
+    I2CMasterIntEnable(I2C2_BASE);
+
+    QueueWrite(REG_CONTROL, 0x06); // starts sensor in continuous mode
+    QueueRead(REG_ID, sensor_id, SENSOR_ID_WORDS);
+    if (RunQueue()) {
+        FlashPBInit(CALIBRATION_FLASH_START, CALIBRATION_FLASH_END, CALIBRATION_BLOCK_SIZE);
+        calibration_cached = LoadCachedCalibration(sensor_id);
+        if (!calibration_cached && InitialiseCalibrationConstants()) {
+            SaveCachedCalibration(sensor_id);
+        }
+    }
+    QueueWrite(REG_STATUS, 0x100); // reset bits in REG_STATUS
+    RunQueue();
+    connect_cycles = TimingElapsed(connect_start);
+}
+
+/*
+ * Returns the CRC of a cached calibration block, skipping the two bytes
+ * flash_pb uses and the CRC itself.
+ */
+static uint32_t CalibrationCrc(CalibrationBlock *block) {
+    uint8_t *start = (uint8_t *)&block->version;
+    return Crc32(0xFFFFFFFF, start, (uint8_t *)&block->crc - start);
+}
+
+/*
+ * Loads the calibration constants from flash if the cached block is intact,
+ * the current layout and taken from the sensor with the given ID.
+ *
+ * Output: true if the constants were loaded.
+ */
+static bool LoadCachedCalibration(uint16_t *sensor_id) {
+    CalibrationBlock *block = (CalibrationBlock *)FlashPBGet();
+    int i;
+
+    if (block == 0 || block->version != CALIBRATION_VERSION || block->crc != CalibrationCrc(block)) {
+        return false;
+    }
+    for (i = 0; i < SENSOR_ID_WORDS; i++) {
+        if (block->sensor_id[i] != sensor_id[i]) {
+            return false;
+        }
+    }
+
+    Gb = block->Gb;
+    Ka = block->Ka;
+    Hb = block->Hb;
+    Fb = block->Fb;
+    Ga = block->Ga;
+    Pr = block->Pr;
+    Po = block->Po;
+    Pt = block->Pt;
+    FaHa = block->FaHa;
+    inverse_Pg = block->inverse_Pg;
+    return true;
+}
+
+/*
+ * Writes the current calibration constants to flash, tagged with the ID of
+ * the sensor they were read from.
+ */
+static void SaveCachedCalibration(uint16_t *sensor_id) {
+    CalibrationBlock block = {0};
+    int i;
+
+    block.version = CALIBRATION_VERSION;
+    for (i = 0; i < SENSOR_ID_WORDS; i++) {
+        block.sensor_id[i] = sensor_id[i];
+    }
+    block.Gb = Gb;
+    block.Ka = Ka;
+    block.Hb = Hb;
+    block.Fb = Fb;
+    block.Ga = Ga;
+    block.Pr = Pr;
+    block.Po = Po;
+    block.Pt = Pt;
+    block.FaHa = FaHa;
+    block.inverse_Pg = inverse_Pg;
+    block.crc = CalibrationCrc(&block);
+    FlashPBSave((uint8_t *)&block);
+}
+
+/*
+ * Initializes relevant calibration constants from the temperature sensor using
+ * addresses and equations given in pages 11, 12 and 23 of the datasheet.
+ * Each 32 bit constant is stored as two words, least significant first, and is
+ * fetched with a single two word sequential read.
+ */
+static bool InitialiseCalibrationConstants() {
+    uint16_t gb, ka, ha, hb;
+    uint16_t fa[2], fb[2], ga[2], pr[2], po[2], pg[2], pt[2];
+
+    QueueRead(0x242E, &gb, 1);
+    QueueRead(0x242F, &ka, 1);
+    QueueRead(0x2481, &ha, 1);
+    QueueRead(0x2482, &hb, 1);
+    QueueRead(0x2428, fa, 2);
+    QueueRead(0x242A, fb, 2);
+    QueueRead(0x242C, ga, 2);
+    QueueRead(0x240C, pr, 2);
+    QueueRead(0x2412, po, 2);
+    QueueRead(0x240E, pg, 2);
+    QueueRead(0x2410, pt, 2);
+    if (!RunQueue()) {
+        return false;
+    }
+
+    Gb = (int16_t)gb * SCALE(10);
+    Ka = (int16_t)ka * SCALE(10);
+    Hb = (int16_t)hb * SCALE(14);
+    Fb = (int32_t)(((uint32_t)fb[1] << 16) | fb[0]) * SCALE(36);
+    Ga = (int32_t)(((uint32_t)ga[1] << 16) | ga[0]) * SCALE(36);
+    Pr = (int32_t)(((uint32_t)pr[1] << 16) | pr[0]) * SCALE(8);
+    Po = (int32_t)(((uint32_t)po[1] << 16) | po[0]) * SCALE(8);
+    Pt = (int32_t)(((uint32_t)pt[1] << 16) | pt[0]) * SCALE(44);
+    FaHa = ((int32_t)(((uint32_t)fa[1] << 16) | fa[0]) * SCALE(46)) * ((int16_t)ha * SCALE(14));
+    inverse_Pg = 1.0f / ((int32_t)(((uint32_t)pg[1] << 16) | pg[0]) * SCALE(20));
+    return true;
+}
+
+/*
+ * Checks the sensor for a new measurement and, if there is one, reads it and
+ * updates the object temperature. The calling task blocks while the transfers
+ * run in the background, for at most TRANSFER_TIMEOUT per queue.
+ *
+ * Output: true if a new temperature was calculated.
+ */
+bool UpdateTemperature() {
+    uint16_t status_reading = 0;
+    uint16_t ram[RAM_BLOCK_WORDS]; // RAM_4 to RAM_9
+    uint16_t RAM_A, RAM_B;
+    int16_t cycle_position;
+
+    QueueRead(REG_STATUS, &status_reading, 1);
+    if (!RunQueue()) {
+        failed_updates++;
+        return false;
+    }
+
+    if ((status_reading & 1) == 0) { // Check if sensor has new reading
+        return false;
+    }
+
+    // the whole RAM block in a single transaction, then clear REG_STATUS
+    QueueRead(REG_RAM_4, ram, RAM_BLOCK_WORDS);
+    QueueWrite(REG_STATUS, 0x100); // reset bits in REG_STATUS
+    if (!RunQueue()) {
+        failed_updates++;
+        return false;
+    }
+
+    // (RAM_4 and RAM_5) and (RAM_7 and RAM_8) should be used alternatively.
+    // 0,2,4 .... N-2 measurements for (RAM_4 and RAM_5)
+    // 1,3,5 .... N-1 measurements for (RAM_7 and RAM_8)
+    cycle_position = ((status_reading & 0b1111100) >> 2);
+    if (cycle_position % 2 == 0) {
+        RAM_A = ram[RAM_INDEX(REG_RAM_4)];
+        RAM_B = ram[RAM_INDEX(REG_RAM_5)];
+    } else {
+        RAM_A = ram[RAM_INDEX(REG_RAM_7)];
+        RAM_B = ram[RAM_INDEX(REG_RAM_8)];
+    }
+
+    temperature_C = CalculateTemperature(temperature_C, status_reading,
+                                         ram[RAM_INDEX(REG_RAM_6)], ram[RAM_INDEX(REG_RAM_9)],
+                                         RAM_A, RAM_B);
+    return true;
+}
+
+/*
+ * Returns the most recently calculated object temperature of the motor.
+ */
+double GetTemperature() {
+    return temperature_C;
+}
+
+/*
+ * Returns how many temperature updates were abandoned because of a bus error
+ * or timeout.
+ */
+uint32_t GetTemperatureFailures() {
+    return failed_updates;
+}
+
+/*
+ * Returns the CPU cycles ConnectWithTemperatureSensor took at boot.
+ */
+uint32_t GetTemperatureConnectCycles() {
+    return connect_cycles;
+}
+
+/*
+ * Returns whether the calibration constants were loaded from the flash cache
+ * at boot rather than read from the sensor.
+ */
+bool IsTemperatureCalibrationCached() {
+    return calibration_cached;
+}
+
+/*
+ * Calculates the motor's object temperature based on current iteration's sensor readings.
+ * Everything stays in single precision so it runs on the FPU, and the fourth
+ * power and root are done with multiplications and two square roots.
+ */
+static float CalculateTemperature(float temperature_old, int16_t status_reading,
+                                  int16_t RAM_6, int16_t RAM_9, int16_t RAM_A, int16_t RAM_B) {
+    float RAM_6_12, AMB, AMB_Pr, Ta_C, Ta_K, Ta_K2, To_K4, S, STO, VRTA, VRTO;
+
+    // Calculation of object temperature using values and procedure giving in section 12 of datasheet.
+    RAM_6_12 = RAM_6 / 12.0f;
+    VRTA = RAM_9 + Gb * RAM_6_12;
+    AMB = (RAM_6 / VRTA) * RAM_SCALE;
+    AMB_Pr = AMB - Pr;
+    Ta_C = Po + AMB_Pr * inverse_Pg + Pt * AMB_Pr * AMB_Pr;
+    S = (RAM_A + RAM_B) * 0.5f;
+    VRTO = RAM_9 + Ka * RAM_6_12;
+    STO = (S / VRTO) * RAM_SCALE;
+    Ta_K = Ta_C + KELVIN_OFFSET_F;
+    Ta_K2 = Ta_K * Ta_K;
+    To_K4 = (STO / (FaHa * (1.0f + Ga * (temperature_old - TO_O) + Fb * (Ta_C - TA_O)))) + Ta_K2 * Ta_K2;
+    return sqrtf(sqrtf(To_K4)) - KELVIN_OFFSET_F - Hb;
+}
+
+/*
+ * Adds a write of the given data packet to the given register address to the
+ * transfer queue.
+ */
+static void QueueWrite(uint16_t register_address, uint16_t data_packet) {
+    Transfer *transfer;
+
+    if (queued_transfers >= TRANSFER_QUEUE_SIZE) {
+        return;
+    }
+    transfer = &transfer_queue[queued_transfers++];
+    transfer->address = register_address;
+    transfer->write = true;
+    transfer->value = data_packet;
+    transfer->data = 0;
+    transfer->count = 0;
+}
+
+/*
+ * Adds a read of count consecutive 16 bit registers starting at the given
+ * address to the transfer queue.
+ */
+static void QueueRead(uint16_t register_address, uint16_t *data, uint16_t count) {
+    Transfer *transfer;
+
+    if (queued_transfers >= TRANSFER_QUEUE_SIZE) {
+        return;
+    }
+    transfer = &transfer_queue[queued_transfers++];
+    transfer->address = register_address;
+    transfer->write = false;
+    transfer->value = 0;
+    transfer->data = data;
+    transfer->count = count;
+}
+
+/*
+ * Runs every queued transfer in order and empties the queue. Inside a task
+ * the transfers are driven by the I2C interrupt while the task blocks on a
+ * semaphore; before BIOS has started the interrupt status is polled instead.
+ * Either way the wait is bounded and a stuck bus abandons the queue.
+ *
+ * Output: true if every transfer completed without a bus error.
+ */
+static bool RunQueue() {
+    uint32_t polls = 0;
+    UInt key;
+
+    if (queued_transfers == 0) {
+        return true;
+    }
+
+    transfer_failed = false;
+    current_transfer = 0;
+    Semaphore_reset(transfer_done, 0);
+    StartTransfer();
+
+    if (BIOS_getThreadType() == BIOS_ThreadType_Task) {
+        if (!Semaphore_pend(transfer_done, TRANSFER_TIMEOUT)) {
+            key = Hwi_disable();
+            if (phase != PHASE_IDLE) {
+                I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+                FinishQueue(true);
+            }
+            Hwi_restore(key);
+        }
+    } else {
+        while (phase != PHASE_IDLE) {
+            if (I2CMasterIntStatus(I2C2_BASE, false)) {
+                I2CMasterIntClear(I2C2_BASE);
+                StepTransfer();
+            } else if (++polls > BOOT_POLL_LIMIT) {
+                I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+                FinishQueue(true);
+            } else {
+                SysCtlDelay(BOOT_POLL_DELAY);
+            }
+        }
+    }
+
+    queued_transfers = 0;
+    return !transfer_failed;
+}
+
+/*
+ * Sends the first byte of the current transfer, the high byte of its register
+ * address, as described in page 16 of the MLX90632 datasheet.
+ */
+static void StartTransfer() {
+    Transfer *transfer = &transfer_queue[current_transfer];
+
+    phase = PHASE_ADDRESS_HIGH;
+    I2CMasterSlaveAddrSet(I2C2_BASE, T_SLAVE_ADDRESS, false);
+    I2CMasterDataPut(I2C2_BASE, transfer->address >> 8);
+    I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_START);
+}
+
+static void FinishQueue(bool failed) {
+    transfer_failed = failed;
+    phase = PHASE_IDLE;
+    Semaphore_post(transfer_done);
+}
+
+/*
+ * Advances the current transfer by one byte. Called once the previous byte
+ * has finished on the bus.
+ */
+static void StepTransfer() {
+    Transfer *transfer = &transfer_queue[current_transfer];
+    uint16_t word;
+
+    if (phase == PHASE_IDLE) {
+        return;
+    }
+
+    if (I2CMasterErr(I2C2_BASE) != I2C_MASTER_ERR_NONE) {
+        if (phase == PHASE_RECEIVE) {
+            I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_RECEIVE_ERROR_STOP);
+        } else {
+            I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+        }
+        FinishQueue(true);
+        return;
+    }
+
+    switch (phase) {
+    case PHASE_ADDRESS_HIGH:
+        phase = PHASE_ADDRESS_LOW;
+        I2CMasterDataPut(I2C2_BASE, transfer->address & 0xff);
+        I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
+        return;
+    case PHASE_ADDRESS_LOW:
+        if (transfer->write) {
+            phase = PHASE_DATA_HIGH;
+            I2CMasterDataPut(I2C2_BASE, transfer->value >> 8);
+            I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
+        } else {
+            // repeated start in read mode, every word is two bytes
+            phase = PHASE_RECEIVE;
+            bytes_left = transfer->count * 2;
+            I2CMasterSlaveAddrSet(I2C2_BASE, T_SLAVE_ADDRESS, true);
+            I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_RECEIVE_START);
+        }
+        return;
+    case PHASE_DATA_HIGH:
+        phase = PHASE_DATA_LOW;
+        I2CMasterDataPut(I2C2_BASE, transfer->value & 0xff);
+        I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_SEND_FINISH);
+        return;
+    case PHASE_DATA_LOW:
+        break;
+    case PHASE_RECEIVE:
+        word = (transfer->count * 2 - bytes_left) / 2;
+        if (bytes_left % 2 == 0) {
+            transfer->data[word] = I2CMasterDataGet(I2C2_BASE) << 8;
+        } else {
+            transfer->data[word] |= I2CMasterDataGet(I2C2_BASE) & 0xff;
+        }
+        --bytes_left;
+        if (bytes_left == 1) {
+            I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_RECEIVE_FINISH);
+            return;
+        } else if (bytes_left > 1) {
+            I2CMasterControl(I2C2_BASE, I2C_MASTER_CMD_BURST_RECEIVE_CONT);
+            return;
+        }
+        break;
+    default:
+        return;
+    }
+
+    // current transfer is complete, move on to the next one
+    if (++current_transfer < queued_transfers) {
+        StartTransfer();
+    } else {
+        FinishQueue(false);
+    }
+}
+
+/*
+ * I2C2 interrupt, raised each time a byte finishes on the bus.
+ */
+void TemperatureIntHandler() {
+    I2CMasterIntClear(I2C2_BASE);
+    StepTransfer();
+}
@@ -1,9 +1,17 @@
-#ifndef MOTOR_TEMPERATURE_H_
-#define MOTOR_TEMPERATURE_H_
-
-#define KELVIN_OFFSET 273.15
-
-void ConnectWithTemperatureSensor();
-double GetTemperature();
-
-#endif /* MOTOR_TEMPERATURE_H_ */
+#ifndef MOTOR_TEMPERATURE_H_
+#define MOTOR_TEMPERATURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define KELVIN_OFFSET 273.15
+
+void ConnectWithTemperatureSensor();
+bool UpdateTemperature();
+double GetTemperature();
+uint32_t GetTemperatureFailures();
+uint32_t GetTemperatureConnectCycles();
+bool IsTemperatureCalibrationCached();
+void TemperatureIntHandler();
+
+#endif /* MOTOR_TEMPERATURE_H_ */
@@ -0,0 +1,106 @@
+#include <stdbool.h>
+#include <xdc/std.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include "thermal.h"
+
+#define CORRECTION_GAIN 0.3f // share of the model error removed at each sensor reading
+#define AMBIENT_GAIN 0.05f // share of the model error learned as an ambient offset
+#define MODEL_STEP 0.1f // seconds of current collected between model steps
+
+/*
+ * Function Prototypes
+ */
+void ThermalModelInit(float temperature);
+void ThermalModelSetParameters(float time_constant, float rise_per_amp2);
+void ThermalModelUpdate(float current_mean_square, float period);
+void ThermalModelCorrect(float measured);
+float GetPredictedTemperature();
+float GetThermalDerating(float limit);
+
+/*
+ * First order winding model: the winding heats in proportion to I^2 and
+ * loses heat in proportion to how far it is above ambient,
+ *
+ *   dT/dt = (ambient + rise_per_amp2 * I^2 - T) / time_constant
+ *
+ * The sensor only reads twice a second, the model runs on the current blocks
+ * in between and is pulled back towards each real reading. A single block
+ * moves the temperature by a few millionths of a degree, less than a float
+ * resolves at 30 C, so the blocks' I^2 is collected and the model stepped
+ * every MODEL_STEP.
+ */
+static float time_constant = THERMAL_TIME_CONSTANT;
+static float rise_per_amp2 = THERMAL_RISE_PER_AMP2;
+static float ambient = 25;
+static volatile float predicted = 25;
+static float heating_sum = 0; // I^2 * t collected since the last model step, A^2 s
+static float heating_time = 0; // s
+
+/*
+ * Starts the model at the given temperature, taken as the ambient too.
+ */
+void ThermalModelInit(float temperature) {
+    ambient = temperature;
+    predicted = temperature;
+}
+
+void ThermalModelSetParameters(float new_time_constant, float new_rise_per_amp2) {
+    if (new_time_constant > 0) {
+        time_constant = new_time_constant;
+    }
+    if (new_rise_per_amp2 >= 0) {
+        rise_per_amp2 = new_rise_per_amp2;
+    }
+}
+
+/*
+ * Advances the model by period seconds with the given mean square motor
+ * current, in A^2. That is the mean of I^2 over the period, not the square
+ * of the mean current, which reads low whenever the current ripples.
+ */
+void ThermalModelUpdate(float current_mean_square, float period) {
+    float steady_state;
+
+    heating_sum += current_mean_square * period;
+    heating_time += period;
+    if (heating_time < MODEL_STEP) {
+        return;
+    }
+    steady_state = ambient + rise_per_amp2 * (heating_sum / heating_time);
+    predicted += (steady_state - predicted) * (heating_time / time_constant);
+    heating_sum = 0;
+    heating_time = 0;
+}
+
+/*
+ * Pulls the model towards a real temperature reading. Part of the error goes
+ * into the ambient estimate, so a persistent model error (a wrong ambient or
+ * heating constant) stops showing up between readings.
+ */
+void ThermalModelCorrect(float measured) {
+    UInt key = Hwi_disable();
+    float error = measured - predicted;
+    predicted += CORRECTION_GAIN * error;
+    ambient += AMBIENT_GAIN * error;
+    Hwi_restore(key);
+}
+
+float GetPredictedTemperature() {
+    return predicted;
+}
+
+/*
+ * Returns how much of the full duty cycle should be allowed for the given
+ * temperature limit: 1 up to THERMAL_DERATE_BAND below the limit, falling to
+ * 0 at the limit itself.
+ */
+float GetThermalDerating(float limit) {
+    float headroom = limit - predicted;
+
+    if (headroom >= THERMAL_DERATE_BAND) {
+        return 1;
+    } else if (headroom <= 0) {
+        return 0;
+    }
+    return headroom / THERMAL_DERATE_BAND;
+}
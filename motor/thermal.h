@@ -0,0 +1,17 @@
+#ifndef MOTOR_THERMAL_H_
+#define MOTOR_THERMAL_H_
+
+#include <stdbool.h>
+
+#define THERMAL_TIME_CONSTANT 60.0f // seconds for the winding to cover 63% of a temperature step
+#define THERMAL_RISE_PER_AMP2 5.0f // steady state rise above ambient per A^2, degrees C
+#define THERMAL_DERATE_BAND 10.0f // degrees C below the limit where the duty limit starts to fall
+
+void ThermalModelInit(float temperature);
+void ThermalModelSetParameters(float time_constant, float rise_per_amp2);
+void ThermalModelUpdate(float current_mean_square, float period);
+void ThermalModelCorrect(float measured);
+float GetPredictedTemperature();
+float GetThermalDerating(float limit);
+
+#endif /* MOTOR_THERMAL_H_ */
@@ -0,0 +1,48 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <inc/hw_types.h>
+#include "timing.h"
+
+/*
+ * Cortex-M4 debug and trace registers (section 2.5 of the TM4C129XNCZAD
+ * datasheet refers to the ARMv7-M architecture reference manual for these).
+ */
+#define DEMCR 0xE000EDFC
+#define DEMCR_TRCENA 0x01000000
+#define DWT_CTRL 0xE0001000
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define DWT_CYCCNT 0xE0001004
+
+/*
+ * Function Prototypes
+ */
+void TimingInit();
+uint32_t TimingNow();
+uint32_t TimingElapsed(uint32_t since);
+
+/*
+ * Starts the free running CPU cycle counter. TIMERS 0, 1, 2, 3 and 5 are
+ * already taken by the PWM outputs, SYS/BIOS and the touch screen, so the
+ * DWT cycle counter is used for timestamping instead.
+ */
+void TimingInit() {
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+/*
+ * Returns the current value of the cycle counter. It wraps roughly every
+ * 35 seconds at 120 MHz, so only differences between two readings are meaningful.
+ */
+uint32_t TimingNow() {
+    return HWREG(DWT_CYCCNT);
+}
+
+/*
+ * Returns the number of CPU cycles since the given timestamp, correctly
+ * handling a single wrap of the counter.
+ */
+uint32_t TimingElapsed(uint32_t since) {
+    return HWREG(DWT_CYCCNT) - since;
+}
@@ -0,0 +1,12 @@
+#ifndef MOTOR_TIMING_H_
+#define MOTOR_TIMING_H_
+
+#include <stdint.h>
+
+#define TIMING_CLOCK_SPEED 120000000 // Cycle counter runs at the CPU clock
+
+void TimingInit();
+uint32_t TimingNow();
+uint32_t TimingElapsed(uint32_t since);
+
+#endif /* MOTOR_TIMING_H_ */
@@ -0,0 +1,194 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <xdc/std.h>
+#include <xdc/cfg/global.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Swi.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include "motor/measurement.h"
+#include "motor/speed.h"
+#include "ui/tabs.h"
+#include "ui/calendar.h"
+#include "constants.h"
+#include "state.h"
+#include "motor/temperature.h"
+#include "motor/thermal.h"
+#include "motor/timing.h"
+#include "schedule.h"
+
+/**
+ * Splits the periodic work into rate groups so slow work (the I2C temperature
+ * read, screen updates) can never hold up the next control tick. The 1 ms clock
+ * only releases the groups; each one runs at its own priority as set up in
+ * app.cfg. A group that is released again before it finished last time counts
+ * as an overrun.
+ */
+static Clock_Struct clockScheduleStruct;
+static uint32_t ticks = 0;
+static volatile bool busy[RATE_GROUP_COUNT];
+static volatile uint32_t overruns[RATE_GROUP_COUNT];
+static uint32_t boot_cycles = 0; // from TimingInit to the first control tick
+static uint32_t overload_time = 0; // ms the current has been over the limit
+
+uint32_t get_overrun_count(RATE_GROUP group) {
+    return overruns[group];
+}
+
+uint32_t get_boot_cycles() {
+    return boot_cycles;
+}
+
+static bool release(RATE_GROUP group) {
+    if (busy[group]) {
+        overruns[group]++;
+        return false;
+    }
+    busy[group] = true;
+    return true;
+}
+
+// the current sensor's offset leaves the idle reading a little below zero,
+// which is held at 0 mA rather than wrapped by the unsigned conversion
+static uint32_t filteredCurrentMilliamps() {
+    double current = GetFilteredCurrentValue() * 1000;
+    return current > 0 ? (uint32_t)current : 0;
+}
+
+// the measured temperature only updates twice a second, so the thermal
+// model's prediction is checked too and the duty is derated as it nears the limit.
+// Current above the limit is held back by the speed loop's foldback, and only
+// trips the motor if it lasts longer than OVERLOAD_TRIP_TIME
+Void checkWithinLimits(double current, double temp) {
+    float predicted_temp = GetPredictedTemperature();
+
+    if (current > get_current_limit()) {
+        overload_time += PROTECTION_PERIOD;
+    } else {
+        overload_time = 0;
+    }
+
+    if (get_motor_power() == ON) {
+        if (overload_time > OVERLOAD_TRIP_TIME || temp > get_temp_limit() ||
+            predicted_temp > get_temp_limit() || IsMotorFaulty()) {
+            set_motor_power(OFF);
+            StopFaultyMotor();
+        }
+    }
+    SetMotorDutyLimit(GetThermalDerating(get_temp_limit()));
+    SetMotorCurrentLimit(get_current_limit() / 1000.0f, 0); // mA, default soft band
+}
+
+Void updateMotorState(double speed) {
+    switch (get_motor_power()) {
+    case ON:
+        if (speed < (get_motor_speed() * 0.9)) {
+            set_motor_state(STARTING);
+        } else {
+            set_motor_state(RUNNING);
+        }
+        break;
+    case OFF:
+        if (speed >= 100) {
+            set_motor_state(STOPPING);
+        } else {
+            set_motor_state(IDLE);
+        }
+        break;
+    }
+}
+
+// highest priority group, everything that has to happen every tick
+Void controlGroup(UArg arg0, UArg arg1) {
+    if (boot_cycles == 0) {
+        boot_cycles = TimingNow();
+    }
+    RotateMotor();
+    TakeMeasurements();
+
+    if (GetFilteredSpeed() < 100 && ShouldMotorBeStopped()) {
+        StopMotor();
+    }
+    busy[GROUP_CONTROL] = false;
+}
+
+Void protectionGroup(UArg arg0, UArg arg1) {
+    double latest_average_speed = GetFilteredSpeed();
+    double latest_average_current = filteredCurrentMilliamps();
+    double latest_average_temp = GetFilteredTemperature();
+    checkWithinLimits(latest_average_current, latest_average_temp);
+    updateMotorState(latest_average_speed);
+    busy[GROUP_PROTECTION] = false;
+}
+
+// the temperature read blocks on I2C, so this runs as a task that the
+// control and protection groups can preempt
+Void thermalTask(UArg arg0, UArg arg1) {
+    bool whole_second = false, boot_reported = false;
+
+    while (1) {
+        Semaphore_pend(semThermal, BIOS_WAIT_FOREVER);
+        // the control group runs first on the tick that releases this task,
+        // so by now boot_cycles holds the time to the first control tick
+        if (!boot_reported && boot_cycles != 0) {
+            System_printf("boot: %d us to first control tick, temperature sensor %d us (%s)\n",
+                          (int)(boot_cycles / (TIMING_CLOCK_SPEED / 1000000)),
+                          (int)(GetTemperatureConnectCycles() / (TIMING_CLOCK_SPEED / 1000000)),
+                          IsTemperatureCalibrationCached() ? "cached" : "read");
+            boot_reported = true;
+        }
+        MeasureTemperature();
+
+        whole_second = !whole_second;
+        if (whole_second) {
+            IncrementCalendarSecond();
+            increment_run_time();
+            appendToMotorSpeed(GetFilteredSpeed());
+            appendToCurrent(filteredCurrentMilliamps());
+            appendToTemp(GetFilteredTemperature());
+        }
+        busy[GROUP_THERMAL] = false;
+    }
+}
+
+Void uiTask(UArg arg0, UArg arg1) {
+    while (1) {
+        Semaphore_pend(semUi, BIOS_WAIT_FOREVER);
+        update_on_clock_cycle();
+        busy[GROUP_UI] = false;
+    }
+}
+
+Void scheduleRateGroups(UArg arg) {
+    ticks++;
+
+    if (ticks % CONTROL_PERIOD == 0 && release(GROUP_CONTROL)) {
+        Swi_post(swiControl);
+    }
+    if (ticks % PROTECTION_PERIOD == 0 && release(GROUP_PROTECTION)) {
+        Swi_post(swiProtection);
+    }
+    if (ticks % THERMAL_PERIOD == 0 && release(GROUP_THERMAL)) {
+        Semaphore_post(semThermal);
+    }
+    if (ticks % UI_PERIOD == 0 && release(GROUP_UI)) {
+        Semaphore_post(semUi);
+    }
+    if (ticks >= UI_PERIOD) {
+        ticks = 0;
+    }
+}
+
+void schedule_start() {
+    Clock_Params clkParams;
+    Clock_Params_init(&clkParams);
+    clkParams.startFlag = TRUE;
+    clkParams.period = 1;
+    Clock_construct(
+        &clockScheduleStruct,
+        (Clock_FuncPtr)scheduleRateGroups,
+        1,
+        &clkParams
+    );
+}
@@ -0,0 +1,25 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+#include <stdint.h>
+
+// periods of each rate group, in 1 ms clock ticks
+#define CONTROL_PERIOD    1
+#define PROTECTION_PERIOD 5
+#define THERMAL_PERIOD    500
+#define UI_PERIOD         1000
+
+#define OVERLOAD_TRIP_TIME 500 // ms over the current limit before the motor is stopped
+
+typedef enum RATE_GROUP {
+    GROUP_CONTROL = 0,    // swiControl: commutation, PI and current sampling
+    GROUP_PROTECTION = 1, // swiProtection: limit checks and motor state
+    GROUP_THERMAL = 2,    // taskThermal: temperature, telemetry and run time
+    GROUP_UI = 3,         // taskUi: screen updates
+} RATE_GROUP;
+
+#define RATE_GROUP_COUNT 4
+
+void schedule_start();
+uint32_t get_overrun_count(RATE_GROUP group);
+uint32_t get_boot_cycles();
+#endif // SCHEDULE_H
@@ -1,7 +1,12 @@
 #include <stdint.h>
+#include <stdbool.h>
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/knl/Task.h>
 #include "motor/speed.h"
 #include "constants.h"
 #include "state.h"
+#include "extremes.h"
 
 /**
  * Controls whether on not the motor is turned on
@@ -92,66 +97,160 @@ void increment_run_time() {
 }
 
 /**
- * All the values for motor speed that we're current storing
- * We also keep the last value to make it easier to append to the end
+ * Telemetry history, one sample per series per second from the thermal task.
+ * Each series is a ring buffer, so appending costs the same however deep the
+ * history is. Older data is kept as minute and hour min/max/mean buckets, the
+ * last day of them in about 2 KB per series. The smallest and largest of
+ * the newest LIST_ITEM_COUNT samples, the ones the stats charts show, are
+ * tracked as samples arrive for scaling the charts.
  */
+static HistorySample motorSpeedSamples[HISTORY_DEPTH];
+static HistorySample currentSamples[HISTORY_DEPTH];
+static HistorySample tempSamples[HISTORY_DEPTH];
+static History motorSpeedHistory = { motorSpeedSamples, HISTORY_DEPTH, HISTORY_DEPTH, 0, 0, 0 };
+static History currentHistory = { currentSamples, HISTORY_DEPTH, HISTORY_DEPTH, 0, 0, 0 };
+static History tempHistory = { tempSamples, HISTORY_DEPTH, HISTORY_DEPTH, 0, 0, 0 };
+static Trend motorSpeedTrend;
+static Trend currentTrend;
+static Trend tempTrend;
+static SlidingExtremes motorSpeedExtremes;
+static SlidingExtremes currentExtremes;
+static SlidingExtremes tempExtremes;
+static bool telemetryReady = false;
 
-static uint32_t listMotorSpeed[LIST_ITEM_COUNT] = { 0, 30, 60, 80, 100, 60, 160, 280, 240, 180 };
-static uint32_t listMotorSpeedLargest = 280;
-static uint32_t listCurrent[LIST_ITEM_COUNT] = { 10, 10, 10, 10, 10, 10, 10, 10, 10, 10 };
-static uint32_t listCurrentLargest = 140;
-static uint32_t listTemp[LIST_ITEM_COUNT] = { 20, 20, 20, 20, 20, 20, 20, 20, 20, 20 };
-static uint32_t listTempLargest = 0;
+// the thermal task appends and the ui task reads, neither can see a half
+// written history while the scheduler is off. The series are unsigned, so a
+// reading below zero (the current sensor's offset at idle, say) is kept as 0
+// rather than stored as a huge value that would throw out the chart scaling,
+// the extremes and the trend means.
+static void append(History *history, Trend *trend, SlidingExtremes *extremes, int32_t reading) {
+    uint32_t time = Clock_getTicks();
+    uint32_t value = reading > 0 ? (uint32_t)reading : 0;
+    UInt key = Task_disable();
 
-void append(uint32_t *list, uint32_t value) {
-    for (uint8_t i = 1; i < LIST_ITEM_COUNT; i++) {
-        list[i - 1] = list[i];
+    if (!telemetryReady) {
+        trend_init(&motorSpeedTrend);
+        trend_init(&currentTrend);
+        trend_init(&tempTrend);
+        extremes_init(&motorSpeedExtremes, LIST_ITEM_COUNT);
+        extremes_init(&currentExtremes, LIST_ITEM_COUNT);
+        extremes_init(&tempExtremes, LIST_ITEM_COUNT);
+        telemetryReady = true;
     }
-    list[LIST_ITEM_COUNT - 1] = value;
+    history_append(history, time, value);
+    trend_add(trend, time, value);
+    extremes_push(extremes, value);
+    Task_restore(key);
 }
 
-void appendToMotorSpeed(uint32_t value) {
-    if (value > listMotorSpeedLargest) {
-        listMotorSpeedLargest = value;
-    }
-    append(listMotorSpeed, value);
+static uint16_t snapshot(History *history, HistorySample *samples, uint16_t count, uint32_t *first) {
+    UInt key = Task_disable();
+    count = history_snapshot(history, samples, count);
+    *first = history_appended(history) - count;
+    Task_restore(key);
+    return count;
+}
 
+static uint16_t trend_copy(Trend *trend, TREND_TIER tier, TrendBucket *buckets, uint16_t count) {
+    UInt key = Task_disable();
+    count = telemetryReady ? trend_snapshot(trend, tier, buckets, count) : 0;
+    Task_restore(key);
+    return count;
 }
 
-void appendToCurrent(uint32_t value) {
-    if (value > listCurrentLargest) {
-        listCurrentLargest = value;
-    }
-    append(listCurrent, value);
+static uint32_t largest(SlidingExtremes *extremes) {
+    UInt key = Task_disable();
+    uint32_t value = extremes_largest(extremes);
+    Task_restore(key);
+    return value;
 }
 
-void appendToTemp(uint32_t value) {
-    if (value > listTempLargest) {
-        listTempLargest = value;
-    }
-    append(listTemp, value);
+static uint32_t smallest(SlidingExtremes *extremes) {
+    UInt key = Task_disable();
+    uint32_t value = extremes_smallest(extremes);
+    Task_restore(key);
+    return value;
+}
+
+void appendToMotorSpeed(int32_t value) {
+    append(&motorSpeedHistory, &motorSpeedTrend, &motorSpeedExtremes, value);
+}
+
+void appendToCurrent(int32_t value) {
+    append(&currentHistory, &currentTrend, &currentExtremes, value);
+}
+
+void appendToTemp(int32_t value) {
+    append(&tempHistory, &tempTrend, &tempExtremes, value);
+}
+
+/**
+ * Changes how many samples each series keeps, up to HISTORY_DEPTH. The
+ * histories start again empty.
+ */
+void set_history_depth(uint16_t depth) {
+    UInt key = Task_disable();
+    history_set_depth(&motorSpeedHistory, depth);
+    history_set_depth(&currentHistory, depth);
+    history_set_depth(&tempHistory, depth);
+    Task_restore(key);
+}
+
+/**
+ * Copy the newest count samples of a series into samples, oldest first.
+ * Returns how many there were, with the number of the oldest one in first.
+ */
+uint16_t get_motor_speed_history(HistorySample *samples, uint16_t count, uint32_t *first) {
+    return snapshot(&motorSpeedHistory, samples, count, first);
 }
 
-uint32_t *get_motor_speed_list() {
-    return listMotorSpeed;
+/**
+ * Copy the newest count minute or hour buckets of a series, oldest first, the
+ * last one still filling. Returns how many there were.
+ */
+uint16_t get_motor_speed_trend(TREND_TIER tier, TrendBucket *buckets, uint16_t count) {
+    return trend_copy(&motorSpeedTrend, tier, buckets, count);
 }
 
+/**
+ * Largest and smallest of the newest LIST_ITEM_COUNT samples of a series.
+ */
 uint32_t get_largest_motor_speed() {
-    return listMotorSpeedLargest;
+    return largest(&motorSpeedExtremes);
+}
+
+uint32_t get_smallest_motor_speed() {
+    return smallest(&motorSpeedExtremes);
 }
 
-uint32_t *get_current_list() {
-    return listCurrent;
+uint16_t get_current_history(HistorySample *samples, uint16_t count, uint32_t *first) {
+    return snapshot(&currentHistory, samples, count, first);
+}
+
+uint16_t get_current_trend(TREND_TIER tier, TrendBucket *buckets, uint16_t count) {
+    return trend_copy(&currentTrend, tier, buckets, count);
 }
 
 uint32_t get_largest_current() {
-    return listCurrentLargest;
+    return largest(&currentExtremes);
+}
+
+uint32_t get_smallest_current() {
+    return smallest(&currentExtremes);
 }
 
-uint32_t *get_temp_list() {
-    return listTemp;
+uint16_t get_temp_history(HistorySample *samples, uint16_t count, uint32_t *first) {
+    return snapshot(&tempHistory, samples, count, first);
+}
+
+uint16_t get_temp_trend(TREND_TIER tier, TrendBucket *buckets, uint16_t count) {
+    return trend_copy(&tempTrend, tier, buckets, count);
 }
 
 uint32_t get_largest_temp() {
-    return listTempLargest;
+    return largest(&tempExtremes);
+}
+
+uint32_t get_smallest_temp() {
+    return smallest(&tempExtremes);
 }
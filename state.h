@@ -2,6 +2,8 @@
 #define STATE_H
 #include <stdint.h>
 #include "constants.h"
+#include "history.h"
+#include "trend.h"
 
 MOTOR_POWER get_motor_power();
 void set_motor_power(MOTOR_POWER power);
@@ -28,17 +30,25 @@ typedef struct ListItem {
     struct ListItem* next;
 } ListItem;
 
-#define LIST_ITEM_COUNT 50
+#define LIST_ITEM_COUNT 50 // points shown on the stats charts
+#define HISTORY_DEPTH 600 // samples kept per series, 10 minutes at 1 Hz
 
-uint32_t *get_motor_speed_list();
-uint32_t *get_current_list();
-uint32_t *get_temp_list();
+void set_history_depth(uint16_t depth);
+uint16_t get_motor_speed_history(HistorySample *samples, uint16_t count, uint32_t *first);
+uint16_t get_current_history(HistorySample *samples, uint16_t count, uint32_t *first);
+uint16_t get_temp_history(HistorySample *samples, uint16_t count, uint32_t *first);
+uint16_t get_motor_speed_trend(TREND_TIER tier, TrendBucket *buckets, uint16_t count);
+uint16_t get_current_trend(TREND_TIER tier, TrendBucket *buckets, uint16_t count);
+uint16_t get_temp_trend(TREND_TIER tier, TrendBucket *buckets, uint16_t count);
 
 uint32_t get_largest_motor_speed();
 uint32_t get_largest_current();
 uint32_t get_largest_temp();
+uint32_t get_smallest_motor_speed();
+uint32_t get_smallest_current();
+uint32_t get_smallest_temp();
 
-void appendToMotorSpeed(uint32_t value);
-void appendToCurrent(uint32_t value);
-void appendToTemp(uint32_t value);
+void appendToMotorSpeed(int32_t value);
+void appendToCurrent(int32_t value);
+void appendToTemp(int32_t value);
 #endif // STATE_H
@@ -0,0 +1,114 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "trend.h"
+
+static void tier_init(TrendTier *tier, TrendBucket *buckets, uint16_t capacity, uint32_t span);
+static bool tier_add(TrendTier *tier, const TrendBucket *sample, TrendBucket *closed);
+static void bucket_merge(TrendBucket *bucket, const TrendBucket *sample);
+
+void trend_init(Trend *trend) {
+    tier_init(&trend->tiers[TIER_MINUTES], trend->minute_buckets, TREND_MINUTES, MINUTE_MS);
+    tier_init(&trend->tiers[TIER_HOURS], trend->hour_buckets, TREND_HOURS, HOUR_MS);
+}
+
+/**
+ * Folds a sample into the open minute. When it starts a new minute, the
+ * finished minute is folded into the open hour the same way.
+ */
+void trend_add(Trend *trend, uint32_t time, uint32_t value) {
+    TrendBucket sample = { time, value, value, 1, value };
+    TrendBucket minute, hour;
+
+    if (tier_add(&trend->tiers[TIER_MINUTES], &sample, &minute)) {
+        tier_add(&trend->tiers[TIER_HOURS], &minute, &hour);
+    }
+}
+
+/**
+ * Copies the newest buckets of a tier into a flat array, oldest first, and
+ * returns how many were copied. The last one is the bucket still being
+ * filled, so the newest samples are always covered.
+ */
+uint16_t trend_snapshot(const Trend *trend, TREND_TIER tier, TrendBucket *buckets, uint16_t newest) {
+    const TrendTier *source = &trend->tiers[tier];
+    uint16_t closed, index, copied = 0;
+
+    if (newest == 0 || source->open.count == 0) {
+        return 0;
+    }
+
+    closed = newest - 1;
+    if (closed > source->count) {
+        closed = source->count;
+    }
+
+    index = source->head >= closed ? source->head - closed : source->head + source->capacity - closed;
+    while (copied < closed) {
+        buckets[copied++] = source->buckets[index];
+        index++;
+        if (index >= source->capacity) {
+            index = 0;
+        }
+    }
+    buckets[copied++] = source->open;
+    return copied;
+}
+
+uint32_t trend_bucket_mean(const TrendBucket *bucket) {
+    if (bucket->count == 0) {
+        return 0;
+    }
+    return (uint32_t)(bucket->sum / bucket->count);
+}
+
+static void tier_init(TrendTier *tier, TrendBucket *buckets, uint16_t capacity, uint32_t span) {
+    tier->buckets = buckets;
+    tier->capacity = capacity;
+    tier->head = 0;
+    tier->count = 0;
+    tier->span = span;
+    tier->open.count = 0;
+}
+
+/**
+ * Adds a sample (or a whole finer bucket) to the tier. Returns true, with
+ * the finished bucket in closed, if it belonged to a later bucket than the
+ * open one.
+ */
+static bool tier_add(TrendTier *tier, const TrendBucket *sample, TrendBucket *closed) {
+    uint32_t start = sample->time - sample->time % tier->span;
+    bool rolled = false;
+
+    if (tier->open.count > 0 && start != tier->open.time) {
+        *closed = tier->open;
+        tier->buckets[tier->head] = tier->open;
+        tier->head++;
+        if (tier->head >= tier->capacity) {
+            tier->head = 0;
+        }
+        if (tier->count < tier->capacity) {
+            tier->count++;
+        }
+        tier->open.count = 0;
+        rolled = true;
+    }
+
+    if (tier->open.count == 0) {
+        tier->open = *sample;
+        tier->open.time = start;
+    } else {
+        bucket_merge(&tier->open, sample);
+    }
+    return rolled;
+}
+
+static void bucket_merge(TrendBucket *bucket, const TrendBucket *sample) {
+    if (sample->min < bucket->min) {
+        bucket->min = sample->min;
+    }
+    if (sample->max > bucket->max) {
+        bucket->max = sample->max;
+    }
+    bucket->sum += sample->sum;
+    bucket->count += sample->count;
+}
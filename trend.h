@@ -0,0 +1,54 @@
+#ifndef TREND_H
+#define TREND_H
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TREND_MINUTES 60 // minute buckets kept, the last hour
+#define TREND_HOURS 24   // hour buckets kept, the last day
+
+#define MINUTE_MS 60000
+#define HOUR_MS 3600000
+
+typedef enum TREND_TIER {
+    TIER_MINUTES = 0,
+    TIER_HOURS = 1,
+} TREND_TIER;
+
+// summary of every sample that arrived within one minute or hour
+typedef struct TrendBucket {
+    uint32_t time;  // ms since boot of the start of the bucket
+    uint32_t min;
+    uint32_t max;
+    uint32_t count; // 0 for a bucket that saw no samples
+    uint64_t sum;   // an hour of large values passes 2^32
+} TrendBucket;
+
+/**
+ * Ring buffer of closed buckets, plus the bucket still being filled. A sample
+ * from a later bucket closes the open one into the ring.
+ */
+typedef struct TrendTier {
+    TrendBucket *buckets;
+    uint16_t capacity;
+    uint16_t head;
+    uint16_t count;
+    uint32_t span; // ms per bucket
+    TrendBucket open;
+} TrendTier;
+
+/**
+ * Downsampled history of one series. Each sample is folded into the open
+ * minute bucket, and each closed minute into the open hour bucket, so the
+ * cost per sample doesn't depend on how much history is kept.
+ */
+typedef struct Trend {
+    TrendTier tiers[2];
+    TrendBucket minute_buckets[TREND_MINUTES];
+    TrendBucket hour_buckets[TREND_HOURS];
+} Trend;
+
+void trend_init(Trend *trend);
+void trend_add(Trend *trend, uint32_t time, uint32_t value);
+uint16_t trend_snapshot(const Trend *trend, TREND_TIER tier, TrendBucket *buckets, uint16_t newest);
+uint32_t trend_bucket_mean(const TrendBucket *bucket);
+#endif // TREND_H
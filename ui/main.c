@@ -7,7 +7,6 @@
 #include <driverlib/rom_map.h>
 #include <inc/hw_memmap.h>
 #include <ti/sysbios/knl/Task.h>
-#include <ti/sysbios/knl/Clock.h>
 #include "drivers/kentec320x240x16_ssd2119.h"
 #include "drivers/frame.h"
 #include "drivers/touch.h"
@@ -16,6 +15,7 @@
 #include "motor/speed.h"
 #include "../constants.h"
 #include "../state.h"
+#include "../schedule.h"
 #include "tabs.h"
 #include "tabs/home.h"
 #include "main.h"
@@ -23,10 +23,6 @@
 
 #define TASKSTACKSIZE   512
 
-int counter = 0;
-Clock_Struct clockRuntimeTrackerStruct;
-Clock_Struct clockTakeMeasurementStruct;
-
 MOTOR_STATE last_known_state;
 
 // this task runs when the system is idle
@@ -52,63 +48,9 @@ Void idleTask() {
     }
     // process anything pending
     WidgetMessageQueueProcess();
-}
-
-Void checkWithinLimits(double current, double temp) {
-    if (get_motor_power() == ON) {
-        if (current > get_current_limit() || temp > get_temp_limit() || IsMotorFaulty()) {
-            set_motor_power(OFF);
-            StopFaultyMotor();
-        }
-    }
-}
-
-Void updateMotorState(double speed) {
-    switch (get_motor_power()) {
-    case ON:
-        if (speed < (get_motor_speed() * 0.9)) {
-            set_motor_state(STARTING);
-        } else {
-            set_motor_state(RUNNING);
-        }
-        break;
-    case OFF:
-        if (speed >= 100) {
-            set_motor_state(STOPPING);
-        } else {
-            set_motor_state(IDLE);
-        }
-        break;
-    }
-}
-
-Void clockRuntimeTracker(UArg arg) {
-    counter++;
-    RotateMotor();
-    TakeMeasurements();
-
-    double latest_average_speed = GetFilteredSpeed();
-    double latest_average_current = GetFilteredCurrentValue() * 1000;
-    double latest_average_temp = GetFilteredTemperature();
-    checkWithinLimits(latest_average_current, latest_average_temp);
-    updateMotorState(latest_average_speed);
-
-    if (counter >= 1000) {
-        MeasureTemperature();
-        IncrementCalendarSecond();
-        increment_run_time();
-        appendToMotorSpeed(latest_average_speed);
-        appendToCurrent(latest_average_current);
-        appendToTemp(latest_average_temp);
-        update_on_clock_cycle();
-        counter = 0;
-    } else if (counter == 500) {
-        MeasureTemperature();
-    }
-
-    if (latest_average_speed < 100 && ShouldMotorBeStopped()) {
-        StopMotor();
-    }
+    // send what was drawn to the panel, a no-op unless
+    // the display driver keeps a back buffer
+    GrFlush(&g_sContext);
 }
 
 void ui_setup(uint32_t sysclock, int hardware_status) {
@@ -133,17 +75,8 @@ void ui_setup(uint32_t sysclock, int hardware_status) {
   }
 
   //SetMotorSpeed(500);
-  // set up clock to track run time
-  Clock_Params clkParams;
-  Clock_Params_init(&clkParams);
-  clkParams.startFlag = TRUE;
-  clkParams.period = 1;
-  Clock_construct(
-      &clockRuntimeTrackerStruct,
-      (Clock_FuncPtr)clockRuntimeTracker,
-      1,
-      &clkParams
-  );
+  // start the rate groups, this also tracks run time
+  schedule_start();
 
   // Perform all setup functionality **here**
   setup_tabs(); // buttons are setup now
@@ -124,6 +124,8 @@ void update_on_clock_cycle() {
         home_updateRuntime();
     } else if (selected_panel == STATS) {
         stats_redrawGraphs();
+    } else if (selected_panel == SETTINGS) {
+        settings_update();
     }
 }
 
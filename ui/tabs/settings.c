@@ -10,6 +10,9 @@
 #include "utils/ustdlib.h"
 #include "drivers/kentec320x240x16_ssd2119.h"
 #include "state.h"
+#include "motor/speed.h"
+#include "motor/autotune.h"
+#include "motor/benchmark.h"
 #include "../main.h"
 #include "../tabs.h"
 #include "settings.h"
@@ -21,6 +24,8 @@ volatile uint32_t keyboardInputIndex = 0;
 char motorSpeed[20] = "0 rpm";
 char currentLimit[20] = "0 mA";
 char tempLimit[20] = "0 C";
+char autotuneStatus[48] = "Autotune: idle";
+char benchmarkStatus[48] = "Benchmark: idle";
 INPUT_FIELDS visibleField;
 extern tPushButtonWidget buttonMotorSpeed, buttonCurrentLimit, buttonTempLimit;
 extern tCanvasWidget inputMotorSpeed, inputCurrentLimit, inputTempLimit;
@@ -152,6 +157,20 @@ void showTempLimitKeyboard(tWidget *psWidget) {
     setInputAndShowKeyboard(psWidget, INPUT_TEMP_LIMIT);
 }
 
+void onAutotunePress(tWidget *psWidget) {
+    if (!StartSpeedAutotune()) {
+        usprintf(autotuneStatus, "Autotune: start the motor first");
+    }
+    settings_update();
+}
+
+void onBenchmarkPress(tWidget *psWidget) {
+    if (!StartSpeedBenchmark()) {
+        usprintf(benchmarkStatus, "Benchmark: start the motor first");
+    }
+    settings_update();
+}
+
 // should declare the input boxes *here* so I can reference them globally from the handle
 
 // this is just a wee lil' dummy to handle the canvas click
@@ -177,6 +196,65 @@ Canvas(inputTempLimit, 0, 0, 0, &g_sKentec320x240x16_SSD2119,
     CANVAS_STYLE_TEXT | CANVAS_STYLE_TEXT_RIGHT | CANVAS_STYLE_FILL | CANVAS_STYLE_OUTLINE,
     ClrBlack, ClrBlue, ClrWhite, g_psFontCmss20, tempLimit, 0, 0);
 
+RectangularButton(buttonAutotune, 0, 0, 0, &g_sKentec320x240x16_SSD2119,
+    10, 125, 100, 30,
+    PB_STYLE_TEXT | PB_STYLE_FILL | PB_STYLE_RELEASE_NOTIFY, ClrBlue, ClrAqua, 0, ClrWhite,
+    g_psFontCmss20, "Autotune", 0, 0, 0, 0, onAutotunePress);
+Canvas(textAutotuneStatus, 0, 0, 0, &g_sKentec320x240x16_SSD2119,
+    10, 162, 300, 18,
+    CANVAS_STYLE_TEXT | CANVAS_STYLE_TEXT_LEFT | CANVAS_STYLE_FILL,
+    ClrBlack, ClrBlue, ClrWhite, g_psFontCmss16, autotuneStatus, 0, 0);
+RectangularButton(buttonBenchmark, 0, 0, 0, &g_sKentec320x240x16_SSD2119,
+    120, 125, 100, 30,
+    PB_STYLE_TEXT | PB_STYLE_FILL | PB_STYLE_RELEASE_NOTIFY, ClrBlue, ClrAqua, 0, ClrWhite,
+    g_psFontCmss20, "Benchmark", 0, 0, 0, 0, onBenchmarkPress);
+Canvas(textBenchmarkStatus, 0, 0, 0, &g_sKentec320x240x16_SSD2119,
+    10, 181, 300, 18,
+    CANVAS_STYLE_TEXT | CANVAS_STYLE_TEXT_LEFT | CANVAS_STYLE_FILL,
+    ClrBlack, ClrBlue, ClrWhite, g_psFontCmss16, benchmarkStatus, 0, 0);
+
+// keep the autotune progress (and the before/after results once done) on screen
+void settings_update() {
+    const AutotuneReport *report = GetAutotuneReport();
+
+    switch (GetAutotuneState()) {
+    case AUTOTUNE_IDLE:
+        break;
+    case AUTOTUNE_DONE:
+        usprintf(autotuneStatus, "Rise %u -> %ums, overshoot %d -> %d%%",
+                 report->rise_before, report->rise_after,
+                 report->overshoot_before, report->overshoot_after);
+        break;
+    case AUTOTUNE_FAILED:
+        usprintf(autotuneStatus, "Autotune: failed, gains unchanged");
+        break;
+    default:
+        usprintf(autotuneStatus, "Autotune: running...");
+        break;
+    }
+    WidgetPaint((tWidget *)&textAutotuneStatus);
+
+    // the full per step breakdown goes to the SysMin buffer, show the worst case here
+    if (BenchmarkIsRunning()) {
+        usprintf(benchmarkStatus, "Benchmark: running...");
+    } else if (BenchmarkIsDone()) {
+        const BenchmarkReport *bench = GetBenchmarkReport();
+        uint32_t settle = 0, i;
+        int32_t overshoot = 0;
+        for (i = 0; i < bench->step_count; i++) {
+            if (bench->steps[i].settling_time > settle) {
+                settle = bench->steps[i].settling_time;
+            }
+            if (bench->steps[i].overshoot > overshoot) {
+                overshoot = bench->steps[i].overshoot;
+            }
+        }
+        usprintf(benchmarkStatus, "Settle %ums, overshoot %d%%, %u cyc",
+                 settle, overshoot, bench->max_loop_cycles);
+    }
+    WidgetPaint((tWidget *)&textBenchmarkStatus);
+}
+
 void paint_settings(tWidget *psWidget, tContext *psContext) {
     GrContextFontSet(psContext, g_psFontCmss20);
     GrContextForegroundSet(psContext, ClrWhite);
@@ -195,4 +273,8 @@ void paint_settings(tWidget *psWidget, tContext *psContext) {
     WidgetAdd(psWidget, (tWidget *)&inputCurrentLimit);
     WidgetAdd(psWidget, (tWidget *)&buttonTempLimit);
     WidgetAdd(psWidget, (tWidget *)&inputTempLimit);
+    WidgetAdd(psWidget, (tWidget *)&buttonAutotune);
+    WidgetAdd(psWidget, (tWidget *)&textAutotuneStatus);
+    WidgetAdd(psWidget, (tWidget *)&buttonBenchmark);
+    WidgetAdd(psWidget, (tWidget *)&textBenchmarkStatus);
 }
@@ -11,4 +11,5 @@ typedef enum INPUT_FIELDS {
 
 
 void paint_settings(tWidget *psWidget, tContext *psContext);
+void settings_update();
 #endif // UI_TABS_SETTINGS_H
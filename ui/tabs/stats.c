@@ -11,20 +11,24 @@
 #include "stats.h"
 
 static VISIBILITY visibility = LINE_MOTOR_SPEED | LINE_CURRENT | LINE_TEMP;
+static RANGE range = RANGE_SECONDS;
+static bool chart_valid = false; // the chart spans match the display
 
 void draw_charts(tWidget *psWidget, tContext *context);
 
 void toggle_vis_motor_speed();
 void toggle_vis_current();
 void toggle_vis_temp();
+void cycle_range();
 
 void toggle_visibility(VISIBILITY vis) {
     visibility ^= vis;
 }
 
-char speedString[20] = "Speed";
-char currentString[20] = "Current";
-char tempString[20] = "Temp";
+char speedString[LEGEND_LENGTH] = "Speed";
+char currentString[LEGEND_LENGTH] = "Current";
+char tempString[LEGEND_LENGTH] = "Temp";
+char rangeString[8] = "1 s";
 
 RectangularButton(legendMotorSpeed, 0, 0, 0, &g_sKentec320x240x16_SSD2119,
   10, 240 - 24 - 8 - 30, 100, 16,
@@ -41,8 +45,14 @@ RectangularButton(legendTemp, 0, 0, 0, &g_sKentec320x240x16_SSD2119,
   PB_STYLE_TEXT | PB_STYLE_FILL | PB_STYLE_RELEASE_NOTIFY, ClrDeepPink, ClrDeepPink, 0, ClrBlack,
   g_psFontCmss16, tempString, 0, 0, 0, 0, toggle_vis_temp);
 
+RectangularButton(btnRange, 0, 0, 0, &g_sKentec320x240x16_SSD2119,
+  250, 28, 59, 16,
+  PB_STYLE_TEXT | PB_STYLE_FILL | PB_STYLE_RELEASE_NOTIFY, ClrGray, ClrDarkGray, 0, ClrWhite,
+  g_psFontCmss16, rangeString, 0, 0, 0, 0, cycle_range);
+
+// not filled by the canvas, draw_charts() clears it only when it has to
 Canvas(graphArea, 0, 0, 0, &g_sKentec320x240x16_SSD2119,
-       11, 28, 299, 145, CANVAS_STYLE_APP_DRAWN | CANVAS_STYLE_FILL,
+       CHART_LEFT, CHART_TOP, CHART_WIDTH, CHART_HEIGHT, CANVAS_STYLE_APP_DRAWN,
        0, 0, 0, 0, 0, 0, draw_charts);
 
 void paint_legend_item(VISIBILITY filter, tPushButtonWidget *button, uint32_t color) {
@@ -58,6 +68,7 @@ void paint_legend_item(VISIBILITY filter, tPushButtonWidget *button, uint32_t co
     PushButtonFillColorSet(button, fill);
     PushButtonTextColorSet(button, text);
     WidgetPaint((tWidget *)button);
+    chart_valid = false;
     WidgetPaint((tWidget *)&graphArea);
 }
 
@@ -77,7 +88,28 @@ void toggle_vis_temp() {
     paint_legend_item(LINE_TEMP, &legendTemp, ClrDeepPink);
 }
 
+// steps through the last 50 seconds, 50 minutes and 24 hours
+void cycle_range() {
+    range = (range + 1) % RANGE_COUNT;
+    switch (range) {
+        case RANGE_MINUTES:
+            usprintf(rangeString, "1 min");
+            break;
+        case RANGE_HOURS:
+            usprintf(rangeString, "1 h");
+            break;
+        default:
+            usprintf(rangeString, "1 s");
+            break;
+    }
+    WidgetPaint((tWidget *)&btnRange);
+    chart_valid = false;
+    WidgetPaint((tWidget *)&graphArea);
+}
+
 void paint_stats(tWidget *psWidget, tContext *psContext) {
+    // the panel has just been cleared, so the chart starts again
+    chart_valid = false;
     GrContextForegroundSet(psContext, ClrWhite);
     GrLineDraw(psContext, 10, 28, 10, 173);
     GrLineDraw(psContext, 10, 173, 309, 173);
@@ -86,53 +118,360 @@ void paint_stats(tWidget *psWidget, tContext *psContext) {
     WidgetAdd(psWidget, (tWidget *)&legendMotorSpeed);
     WidgetAdd(psWidget, (tWidget *)&legendCurrent);
     WidgetAdd(psWidget, (tWidget *)&legendTemp);
+    WidgetAdd(psWidget, (tWidget *)&btnRange);
     WidgetAdd(psWidget, (tWidget *)&graphArea);
 }
 
 
-uint32_t scale_value(uint32_t largest, uint32_t value) {
-    return 170 - (value * ((float)140 / largest));
+// newest points of each series, refreshed on every repaint. Seconds are
+// copied in as buckets of a single sample so every range draws the same way
+static HistorySample chart_samples[LIST_ITEM_COUNT];
+static TrendBucket chart_buckets[LIST_ITEM_COUNT];
+static uint32_t chart_smallest, chart_largest; // value range the chart is scaled to
+
+typedef uint16_t (*HistoryGetter)(HistorySample *samples, uint16_t count, uint32_t *first);
+typedef uint16_t (*TrendGetter)(TREND_TIER tier, TrendBucket *buckets, uint16_t count);
+typedef uint32_t (*ExtremeGetter)();
+
+typedef struct ChartSeries {
+    VISIBILITY line;
+    uint32_t color;
+    HistoryGetter history;
+    TrendGetter trend;
+    ExtremeGetter smallest;
+    ExtremeGetter largest;
+    tPushButtonWidget *legend;
+    char *legend_text;
+    const char *name;
+    const char *format; // legend text with the latest value
+} ChartSeries;
+
+// in drawing order, later series are drawn over earlier ones
+static const ChartSeries series[SERIES_COUNT] = {
+    { LINE_MOTOR_SPEED, ClrChartreuse, get_motor_speed_history, get_motor_speed_trend,
+      get_smallest_motor_speed, get_largest_motor_speed, &legendMotorSpeed, speedString, "Speed", "Speed: %u rpm" },
+    { LINE_CURRENT, ClrCornflowerBlue, get_current_history, get_current_trend,
+      get_smallest_current, get_largest_current, &legendCurrent, currentString, "Current", "Current: %u mA" },
+    { LINE_TEMP, ClrDeepPink, get_temp_history, get_temp_trend,
+      get_smallest_temp, get_largest_temp, &legendTemp, tempString, "Temp", "Temp: %u C" },
+};
+
+/**
+ * The chart is kept as one vertical span per column per series, which is all
+ * a line chart needs. Comparing the spans about to be drawn with the ones on
+ * screen, only the columns that changed are written to the display, so a
+ * new sample costs a handful of short vertical lines instead of a full
+ * repaint. The seconds range sweeps across the chart like a strip recorder,
+ * each sample going into the slot after the last, so the samples already
+ * drawn stay where they are.
+ */
+static ColumnSpan shown[SERIES_COUNT][CHART_WIDTH]; // what is on the display
+static ColumnSpan next[SERIES_COUNT][CHART_WIDTH];  // what this update draws
+static uint32_t scale_low[SERIES_COUNT], scale_high[SERIES_COUNT];
+
+uint32_t scale_value(uint32_t value) {
+    uint32_t span = chart_largest - chart_smallest;
+
+    if (span == 0) {
+        span = 1;
+    }
+    // a sample newer than the extremes can land just outside them
+    if (value < chart_smallest) {
+        value = chart_smallest;
+    } else if (value > chart_largest) {
+        value = chart_largest;
+    }
+    return 170 - ((value - chart_smallest) * ((float)120 / span));
 }
 
-void draw_chart(tContext *context, uint32_t color, uint32_t *list, uint32_t largest) {
-    GrContextForegroundSet(context, color);
-    for (uint8_t i = 0; i < LIST_ITEM_COUNT; i++) {
-        uint32_t current = scale_value(largest, list[i]);
-        GrCircleDraw(context, LINE_X_VALUE(i), current, CIRCLE_RADIUS);
-        // skip the first because we can't draw a line to nowhere
-        if (i > 0) {
-            uint32_t last = scale_value(largest, list[i - 1]);
-            // draw a line linking the two dots
-            GrLineDraw(context, LINE_X_VALUE(i - 1), last, LINE_X_VALUE(i), current);
+/**
+ * Picks the range a series is scaled to. The second samples come with the
+ * sliding window extremes from state.c. There are only a few dozen buckets,
+ * so their range is found from the snapshot. The range is rounded out to a
+ * step of about an eighth of it and kept while the data fits and fills at
+ * least a quarter of it, so small changes in the extremes don't rescale
+ * (and fully repaint) the chart. Returns whether the range changed.
+ */
+bool scale_chart(uint8_t index, uint16_t count, uint32_t smallest, uint32_t largest) {
+    uint32_t step = 1;
+
+    if (range != RANGE_SECONDS && count > 0) {
+        smallest = chart_buckets[0].min;
+        largest = chart_buckets[0].max;
+        for (uint16_t i = 1; i < count; i++) {
+            if (chart_buckets[i].min < smallest) {
+                smallest = chart_buckets[i].min;
+            }
+            if (chart_buckets[i].max > largest) {
+                largest = chart_buckets[i].max;
+            }
         }
     }
+
+    chart_smallest = scale_low[index];
+    chart_largest = scale_high[index];
+    if (smallest >= chart_smallest && largest <= chart_largest &&
+        largest - smallest >= (chart_largest - chart_smallest) / 4) {
+        return false;
+    }
+
+    // compared by dividing the span, so a span near 2^32 can't wrap the step
+    while (step < (largest - smallest) / 8) {
+        step *= 2;
+    }
+    chart_smallest = smallest - smallest % step;
+    chart_largest = largest - largest % step;
+    chart_largest = chart_largest > UINT32_MAX - step ? UINT32_MAX : chart_largest + step;
+    scale_low[index] = chart_smallest;
+    scale_high[index] = chart_largest;
+    return true;
 }
 
-void draw_charts(tWidget *psWidget, tContext *context) {
-    if (visibility & LINE_MOTOR_SPEED) {
-        uint32_t *motor_speed_list = get_motor_speed_list();
-        draw_chart(context, ClrChartreuse, motor_speed_list, get_largest_motor_speed());
-        usprintf(speedString, "Speed: %u rpm", motor_speed_list[LIST_ITEM_COUNT - 1]);
-    } else {
-        usprintf(speedString, "Speed");
+uint16_t range_points() {
+    return range == RANGE_HOURS ? TREND_HOURS : LIST_ITEM_COUNT;
+}
+
+uint16_t load_chart(const ChartSeries *chart, uint32_t *first) {
+    uint16_t count;
+
+    *first = 0;
+    switch (range) {
+        case RANGE_MINUTES:
+            return chart->trend(TIER_MINUTES, chart_buckets, LIST_ITEM_COUNT);
+        case RANGE_HOURS:
+            return chart->trend(TIER_HOURS, chart_buckets, TREND_HOURS);
+        default:
+            count = chart->history(chart_samples, LIST_ITEM_COUNT, first);
+            for (uint16_t i = 0; i < count; i++) {
+                uint32_t value = chart_samples[i].value;
+                chart_buckets[i] = (TrendBucket){ chart_samples[i].time, value, value, 1, value };
+            }
+            return count;
     }
-    if (visibility & LINE_CURRENT) {
-        uint32_t *current_list = get_current_list();
-        draw_chart(context, ClrCornflowerBlue, current_list, get_largest_current());
-        usprintf(currentString, "Current: %u mA", current_list[LIST_ITEM_COUNT - 1]);
-    } else {
-        usprintf(currentString, "Current");
+}
+
+// widens the span of a column to cover top to bottom, clipped to the chart
+void span_add(ColumnSpan *spans, int32_t x, int32_t top, int32_t bottom) {
+    ColumnSpan *span;
+
+    if (x < CHART_LEFT || x >= CHART_LEFT + CHART_WIDTH) {
+        return;
+    }
+    if (top < CHART_TOP) {
+        top = CHART_TOP;
+    }
+    if (bottom > CHART_BOTTOM) {
+        bottom = CHART_BOTTOM;
+    }
+    if (top > bottom) {
+        return;
     }
-    if (visibility & LINE_TEMP) {
-        uint32_t *temp_list = get_temp_list();
-        draw_chart(context, ClrDeepPink, temp_list, get_largest_temp());
-        usprintf(tempString, "Temp: %u C", temp_list[LIST_ITEM_COUNT - 1]);
+
+    span = &spans[x - CHART_LEFT];
+    if (span->top > span->bottom) {
+        span->top = top;
+        span->bottom = bottom;
     } else {
-        usprintf(tempString, "Temp");
+        if (top < span->top) {
+            span->top = top;
+        }
+        if (bottom > span->bottom) {
+            span->bottom = bottom;
+        }
+    }
+}
+
+/**
+ * Works out the spans of one series: a dot per point, a bar from min to max
+ * for buckets that cover several samples, and a line between neighbouring
+ * points. The seconds range leaves out the oldest sample, whose slot comes
+ * up next, so the gap shows where the sweep is.
+ */
+void rasterise_chart(ColumnSpan *spans, uint16_t count, uint32_t first) {
+    uint16_t points = range_points(), slot, last_slot = 0;
+    int32_t x, y, last_x = 0, last_y = 0;
+    bool sweep = range == RANGE_SECONDS, has_last = false;
+
+    for (uint16_t i = 0; i < count; i++) {
+        TrendBucket *bucket = &chart_buckets[i];
+
+        if (sweep && count == LIST_ITEM_COUNT && i == 0) {
+            continue;
+        }
+        slot = sweep ? (first + i) % LIST_ITEM_COUNT : i;
+        x = LINE_X_VALUE(slot, points);
+        y = scale_value(trend_bucket_mean(bucket));
+
+        // a small round dot, its outer columns a pixel shorter
+        for (int32_t dx = -CIRCLE_RADIUS; dx <= CIRCLE_RADIUS; dx++) {
+            int32_t dy = (dx == -CIRCLE_RADIUS || dx == CIRCLE_RADIUS) ? CIRCLE_RADIUS - 1 : CIRCLE_RADIUS;
+            span_add(spans, x + dx, y - dy, y + dy);
+        }
+        if (bucket->min != bucket->max) {
+            span_add(spans, x, scale_value(bucket->max), scale_value(bucket->min));
+        }
+
+        // each column of the line covers where it enters and leaves it
+        if (has_last && slot == last_slot + 1) {
+            for (int32_t column = last_x; column < x; column++) {
+                int32_t enter = last_y + (y - last_y) * (column - last_x) / (x - last_x);
+                int32_t leave = last_y + (y - last_y) * (column + 1 - last_x) / (x - last_x);
+                span_add(spans, column, enter < leave ? enter : leave, enter < leave ? leave : enter);
+            }
+        }
+
+        last_slot = slot;
+        last_x = x;
+        last_y = y;
+        has_last = true;
+    }
+}
+
+// mean of the newest point drawn, 0 before the first sample arrives
+uint32_t latest_value(uint16_t count) {
+    return count > 0 ? trend_bucket_mean(&chart_buckets[count - 1]) : 0;
+}
+
+// repaints a legend button only when its text changes
+void set_legend(const ChartSeries *chart, const char *text) {
+    if (ustrncmp(chart->legend_text, text, LEGEND_LENGTH) != 0) {
+        ustrncpy(chart->legend_text, text, LEGEND_LENGTH);
+        WidgetPaint((tWidget *)chart->legend);
+    }
+}
+
+/**
+ * Loads and rasterises every series into next. Returns whether any of them
+ * changed scale.
+ */
+bool prepare_charts() {
+    char text[LEGEND_LENGTH];
+    uint32_t first;
+    uint16_t count;
+    bool rescaled = false;
+
+    for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+        const ChartSeries *chart = &series[s];
+
+        for (uint16_t column = 0; column < CHART_WIDTH; column++) {
+            next[s][column].top = EMPTY_SPAN_TOP;
+            next[s][column].bottom = 0;
+        }
+
+        if (!(visibility & chart->line)) {
+            set_legend(chart, chart->name);
+            continue;
+        }
+
+        count = load_chart(chart, &first);
+        if (scale_chart(s, count, chart->smallest(), chart->largest())) {
+            rescaled = true;
+        }
+        rasterise_chart(next[s], count, first);
+
+        usnprintf(text, sizeof(text), chart->format, latest_value(count));
+        set_legend(chart, text);
+    }
+    return rescaled;
+}
+
+bool spans_overlap(const ColumnSpan *a, const ColumnSpan *b) {
+    return a->top <= a->bottom && b->top <= b->bottom && a->top <= b->bottom && b->top <= a->bottom;
+}
+
+bool spans_equal(const ColumnSpan *a, const ColumnSpan *b) {
+    if (a->top > a->bottom || b->top > b->bottom) {
+        return (a->top > a->bottom) == (b->top > b->bottom);
+    }
+    return a->top == b->top && a->bottom == b->bottom;
+}
+
+// blanks rows top to bottom of a column except where a new span will be drawn
+void erase_outside(tContext *context, uint16_t column, int32_t top, int32_t bottom, uint8_t from) {
+    for (uint8_t s = from; s < SERIES_COUNT; s++) {
+        ColumnSpan *span = &next[s][column];
+        if (span->top <= span->bottom && span->top <= bottom && top <= span->bottom) {
+            if (top < span->top) {
+                erase_outside(context, column, top, span->top - 1, s + 1);
+            }
+            if (bottom > span->bottom) {
+                erase_outside(context, column, span->bottom + 1, bottom, s + 1);
+            }
+            return;
+        }
+    }
+    GrContextForegroundSet(context, ClrBlack);
+    GrLineDrawV(context, CHART_LEFT + column, top, bottom);
+}
+
+/**
+ * Brings one column of the display from shown to next. Old pixels are only
+ * cleared where nothing new goes. A series is redrawn if its span changed,
+ * if old pixels of another series may be left inside it, or if a series
+ * drawn before it was redrawn over it.
+ */
+void update_column(tContext *context, uint16_t column) {
+    bool changed[SERIES_COUNT], redraw[SERIES_COUNT], any = false;
+
+    for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+        changed[s] = !spans_equal(&shown[s][column], &next[s][column]);
+        any = any || changed[s];
+    }
+    if (!any) {
+        return;
+    }
+
+    for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+        ColumnSpan *span = &next[s][column];
+
+        redraw[s] = changed[s];
+        for (uint8_t other = 0; other < SERIES_COUNT && !redraw[s]; other++) {
+            redraw[s] = other != s &&
+                        ((changed[other] && spans_overlap(span, &shown[other][column])) ||
+                         (other < s && redraw[other] && spans_overlap(span, &next[other][column])));
+        }
+
+        if (changed[s] && shown[s][column].top <= shown[s][column].bottom) {
+            erase_outside(context, column, shown[s][column].top, shown[s][column].bottom, 0);
+        }
+    }
+
+    for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+        ColumnSpan *span = &next[s][column];
+
+        if (redraw[s] && span->top <= span->bottom) {
+            GrContextForegroundSet(context, series[s].color);
+            GrLineDrawV(context, CHART_LEFT + column, span->top, span->bottom);
+        }
+        shown[s][column] = *span;
+    }
+}
+
+/**
+ * Paint handler of the chart canvas. Only the changed columns are drawn
+ * while the display still shows the previous update; after the panel was
+ * repainted, a series was toggled or the scale changed, the chart is
+ * cleared and drawn in full.
+ */
+void draw_charts(tWidget *psWidget, tContext *context) {
+    tRectangle area = { CHART_LEFT, CHART_TOP, CHART_LEFT + CHART_WIDTH - 1, CHART_BOTTOM };
+    bool rescaled = prepare_charts();
+
+    if (!chart_valid || rescaled) {
+        GrContextForegroundSet(context, ClrBlack);
+        GrRectFill(context, &area);
+        for (uint8_t s = 0; s < SERIES_COUNT; s++) {
+            for (uint16_t column = 0; column < CHART_WIDTH; column++) {
+                shown[s][column].top = EMPTY_SPAN_TOP;
+                shown[s][column].bottom = 0;
+            }
+        }
+        chart_valid = true;
+    }
+
+    for (uint16_t column = 0; column < CHART_WIDTH; column++) {
+        update_column(context, column);
     }
-    WidgetPaint((tWidget *)&legendMotorSpeed);
-    WidgetPaint((tWidget *)&legendTemp);
-    WidgetPaint((tWidget *)&legendCurrent);
 }
 
 void stats_redrawGraphs() {
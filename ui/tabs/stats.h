@@ -10,9 +10,35 @@ typedef enum VISIBILITY {
     LINE_TEMP = 0b100,
 } VISIBILITY;
 
+typedef enum RANGE {
+    RANGE_SECONDS = 0, // one second samples
+    RANGE_MINUTES = 1, // minute buckets
+    RANGE_HOURS = 2,   // hour buckets
+} RANGE;
+
+#define RANGE_COUNT 3
+
 #define CIRCLE_RADIUS 2
+#define LEGEND_LENGTH 20
+
+// chart area inside the axes
+#define CHART_LEFT 11
+#define CHART_TOP 46
+#define CHART_WIDTH 299
+#define CHART_HEIGHT 127
+#define CHART_BOTTOM (CHART_TOP + CHART_HEIGHT - 1)
+
+#define SERIES_COUNT 3
+
+// vertical run of chart pixels in one column, top > bottom when empty
+typedef struct ColumnSpan {
+    uint8_t top;
+    uint8_t bottom;
+} ColumnSpan;
+
+#define EMPTY_SPAN_TOP 0xff
 
-#define LINE_X_VALUE(i) (13 + ((i) * (320 / LIST_ITEM_COUNT)))
+#define LINE_X_VALUE(i, points) (13 + ((i) * (300 / (points))))
 
 void paint_stats(tWidget *psWidget, tContext *psContext);
 void stats_redrawGraphs();